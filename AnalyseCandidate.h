@@ -0,0 +1,199 @@
+#ifndef ANALYSECANDIDATE_H
+#define ANALYSECANDIDATE_H
+
+#include "Species.h"
+#include "CutScan.h"
+#include "DetectorPolicy.h"
+#include "PileupPool.h"
+
+bool IsElectronDetectedInCTS(TLorentzVector, double);
+bool IsPhotonDetectedInEMCAL(TLorentzVector, double, double zVertex = 0.);
+bool IsPhotonDetectedInPHOS (TLorentzVector, double, double zVertex = 0.);
+
+void Invariant_mass_spectr_creator(TLorentzVector, TLorentzVector, unsigned int, const HistList &, double,
+				   double);
+
+// Smearing, acceptance and histogramming of one matched decay chain with
+// the detector Det (see DetectorPolicy.h). Photons are measured in the
+// calorimeters, all other final legs in the tracking system. If scan is
+// not NULL the candidate is also filled into the cut-threshold scan.
+// eventKey holds the run seed and event number of the smearing streams,
+// weight the event weight (1 but for weighted external input).
+// With pileup (see PileupPool.h) pileup photons within the cluster of a
+// signal photon add their energy to it before the smearing, and for one-
+// photon patterns every other pileup photon in PHOS is paired with the
+// candidate's remaining legs, a combinatorial background in the measured
+// mass spectra. The cut scan holds the signal only. In parallel, photons
+// that convert in the material (see ConversionMap.h) are measured by their
+// e+e- pairs for the PCM spectra; the calorimeter conditions ignore the
+// conversions. Histograms are filled as the histogram spec says (see
+// HistSpec.h); the pileup combinations and conversions are only done if
+// some histogram needs them.
+
+template <class Det>
+void AnalyseCandidate(const Pythia8::Event &event, const SpeciesTable &table, int iSpecies,
+		      const std::vector<int> &iNode, const RandomKey &eventKey, double weight,
+		      const PileupEvent *pileup, HistSet &hists, CutScan *scan)
+{
+  const int idPhoton       =  22;
+
+  // standard thresholds of the acceptance conditions
+  const double ctsPtMin    =  1.0;  // CTS track p_T
+  const double emcalEMin   =  2.0;  // EMCAL cluster energy
+  const double phosEMin    =  1.0;  // PHOS cluster energy
+  const double gamEMin2    =  5.0;  // photon energy, condition 2
+  const double gamEMinMass =  2.0;  // photon energy, mass spectra of condition 3
+  const double pcmLegPtMin =  0.05; // conversion leg p_T
+
+  // pileup photons closer than a 3x3 PHOS cluster of 2.2 cm cells merge
+  const double clusterAngle = 3.3/Det::Position::Radius();
+
+  const Species &species = table.species[iSpecies];
+  const DecayPattern &pattern = species.pattern;
+  const SpeciesHists &h = hists.species[iSpecies];
+  const HistList &mass = hists.mass[species.massGroup];
+  const int nLeg = pattern.leaf.size();
+  const double br = species.br;
+
+  // leg and candidate variables of the histogram spec
+  double var[kNVars];
+
+  TLorentzVector pAll, pRes, pAllPcm, pResPcm;
+  bool inCTS   = true;  // all charged legs in CTS
+  bool inEMCAL = true;  // all charged legs in EMCAL
+  bool inPHOS  = true;  // all photons in PHOS
+  bool gamE2   = true;  // all photons with E > gamEMinMass
+  bool gamE5   = true;  // all photons with E > gamEMin2
+  // all photons converted and reconstructed
+  bool inPCM   = !Det::Material::ideal && ((h.candidate.conds | mass.conds) & kCondPcm);
+
+  // geometric acceptance and cut variables of the scan
+  bool inCTSGeo = true, inEMCALGeo = true, inPHOSGeo = true;
+  double cutVar[kScanVars] = {1.e9, 1.e9, 1.e9};
+
+  // the photon leg of one-photon patterns, for the pileup background
+  int nGam = 0;
+  TLorentzVector pGamTrue, pGamSmeared;
+
+  for (int l = 0; l < nLeg; ++l) {
+    int k = pattern.leaf[l];
+    const Pythia8::Particle &leg = event[iNode[k]];
+    TLorentzVector pTrue(leg.px(), leg.py(), leg.pz(), leg.e());
+    TLorentzVector pSmeared;
+    RandomKey key = eventKey;
+    key.particle = iNode[k];
+    double zVertex = 0.1*leg.zProd();  // cm
+
+    if (leg.id() == idPhoton) {
+      TLorentzVector pPair;
+      if (inPCM) inPCM = ConvertPhoton<typename Det::Material, typename Det::Momentum>(pTrue, key, pcmLegPtMin, pPair);
+      pAllPcm += pPair;
+      if (pattern.inResonance[k]) pResPcm += pPair;
+      if (pileup) {
+	PROFILE_STAGE(kStagePileup);
+	double ePileup = 0.;
+	for (size_t ig = 0; ig < pileup->photon.size(); ++ig)
+	  if (pileup->photon[ig].Angle(pTrue.Vect()) < clusterAngle) ePileup += pileup->photon[ig].E();
+	if (ePileup > 0.) pTrue *= 1. + ePileup/pTrue.E();
+      }
+      pSmeared = SmearPhoton<typename Det::Energy, typename Det::Position>(pTrue, key);
+      nGam++;
+      pGamTrue    = pTrue;
+      pGamSmeared = pSmeared;
+      inPHOS = inPHOS && IsPhotonDetectedInPHOS(pSmeared, phosEMin, zVertex);
+      gamE2  = gamE2  && pSmeared.E() > gamEMinMass;
+      gamE5  = gamE5  && pSmeared.E() > gamEMin2;
+      if (scan) {
+	inPHOSGeo = inPHOSGeo && IsPhotonDetectedInPHOS(pSmeared, 0., zVertex);
+	cutVar[2] = TMath::Min(cutVar[2], pSmeared.E());
+      }
+    } else {
+      if (abs(leg.id()) == 11)
+	pTrue = RadiateElectron<typename Det::Material>(pTrue, key);
+      pSmeared = SmearTrack<typename Det::Momentum>(pTrue, key);
+      inCTS   = inCTS   && IsElectronDetectedInCTS(pSmeared, ctsPtMin);
+      inEMCAL = inEMCAL && IsPhotonDetectedInEMCAL(pSmeared, emcalEMin, zVertex);
+      if (scan) {
+	inCTSGeo   = inCTSGeo   && IsElectronDetectedInCTS(pSmeared, 0.);
+	inEMCALGeo = inEMCALGeo && IsPhotonDetectedInEMCAL(pSmeared, 0., zVertex);
+	cutVar[0] = TMath::Min(cutVar[0], pSmeared.Pt());
+	cutVar[1] = TMath::Min(cutVar[1], pSmeared.E());
+      }
+      pAllPcm += pSmeared;
+      if (pattern.inResonance[k]) pResPcm += pSmeared;
+    }
+
+    const HistList &legHists = h.leg[l];
+    if (!legHists.hist.empty()) {
+      PROFILE_STAGE(kStageFill);
+      if (legHists.vars & 1 << kVarPt)  var[kVarPt]  = pSmeared.Pt();
+      if (legHists.vars & 1 << kVarY)   var[kVarY]   = pSmeared.Rapidity();
+      if (legHists.vars & 1 << kVarPhi) var[kVarPhi] = PhiPositive(pSmeared.Phi());
+      if (legHists.vars & 1 << kVarEta) var[kVarEta] = pSmeared.Eta();
+      if (legHists.vars & 1 << kVarE)   var[kVarE]   = pSmeared.E();
+      FillHistList(legHists, kCondAll, var, br, weight);
+    }
+    pAll += pSmeared;
+    if (pattern.inResonance[k]) pRes += pSmeared;
+  }
+
+  // condition 1: charged legs in CTS, photons in PHOS
+  // condition 2: condition 1 and E_gamma > 5 GeV
+  // condition 3: charged legs in EMCAL, photons in PHOS
+  bool cndtn[3];
+  cndtn[0] = inCTS && inPHOS;
+  cndtn[1] = inCTS && inPHOS && gamE5;
+  cndtn[2] = inEMCAL && inPHOS;
+
+  // PCM: charged legs in CTS, every photon reconstructed from its conversion
+  bool pcm = inCTS && inPCM && nGam > 0;
+
+  if (!h.candidate.hist.empty()) {
+    PROFILE_STAGE(kStageFill);
+    const Pythia8::Particle &mother = event[iNode[0]];
+    var[kVarPt]  = mother.pT();
+    var[kVarY]   = mother.y();
+    var[kVarPhi] = PhiPositive(mother.phi());
+    unsigned int conds = kCondAll;
+    if (cndtn[0]) conds |= kCondCndtn1;
+    if (cndtn[1]) conds |= kCondCndtn2;
+    if (cndtn[2]) conds |= kCondCndtn3;
+    if (pcm)      conds |= kCondPcm;
+    FillHistList(h.candidate, conds, var, br, weight);
+  }
+
+  // the mass spectra of condition 3 also require E_gamma > 2 GeV
+  unsigned int massConds = kCondAll;
+  if (cndtn[0])          massConds |= kCondCndtn1;
+  if (cndtn[1])          massConds |= kCondCndtn2;
+  if (cndtn[2] && gamE2) massConds |= kCondCndtn3;
+  Invariant_mass_spectr_creator(pRes, pAll, massConds, mass, br, weight);
+  if (pcm) Invariant_mass_spectr_creator(pResPcm, pAllPcm, kCondPcm, mass, br, weight);
+
+  if (pileup && nGam == 1 && (mass.conds & (kCondCndtn1 | kCondCndtn2 | kCondCndtn3))) {
+    PROFILE_STAGE(kStagePileup);
+    for (size_t ig = 0; ig < pileup->photon.size(); ++ig) {
+      const TLorentzVector &pTrue = pileup->photon[ig];
+      // far below the PHOS threshold after any smearing, or merged above
+      if (pTrue.E() < 0.5*phosEMin || pTrue.Angle(pGamTrue.Vect()) < clusterAngle) continue;
+      RandomKey key = eventKey;
+      key.particle = kPileupParticle + 1 + ig;
+      TLorentzVector pGam = SmearPhoton<typename Det::Energy, typename Det::Position>(pTrue, key);
+      if (!IsPhotonDetectedInPHOS(pGam, phosEMin)) continue;
+      unsigned int condsPileup = 0;
+      if (inCTS)                                condsPileup |= kCondCndtn1;
+      if (inCTS && pGam.E() > gamEMin2)         condsPileup |= kCondCndtn2;
+      if (inEMCAL && pGam.E() > gamEMinMass)    condsPileup |= kCondCndtn3;
+      Invariant_mass_spectr_creator(pRes, pAll - pGamSmeared + pGam, condsPileup, mass, br, weight);
+    }
+  }
+
+  if (scan) {
+    bool inAcc[kScanCndtn] = {inCTSGeo && inPHOSGeo, inEMCALGeo && inPHOSGeo};
+    FillCutScan(*scan, iSpecies, species.massGroup, inAcc, cutVar, pAll.M() - pRes.M(), br*weight);
+  }
+
+  return;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "Bremsstrahlung.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "TMath.h"
+
+// Inverse CDF of the kept fraction z on nT material budgets up to tMax and
+// nQ+1 equidistant quantiles; row i, entry k is the z below which a
+// fraction 1 - k/nQ of the electrons stays (z falls with k).
+
+static const int    nT   = 101;
+static const double tMax = 0.5;
+static const int    nQ   = 1024;
+static std::vector<double> zTable;
+
+static void BuildTable()
+{
+  // -ln z on a logarithmic grid, losses below 1e-12 count as none
+  const int    nY   = 4000;
+  const double yMin = 1.e-12, yMax = 40.;
+  std::vector<double> y(nY), cdf(nY);
+  for (int iy = 0; iy < nY; ++iy) y[iy] = yMin*pow(yMax/yMin, (double)iy/(nY - 1));
+
+  zTable.assign(nT*(nQ + 1), 1.);
+  for (int it = 1; it < nT; ++it) {
+    double a = 4./3. * tMax*it/(nT - 1);
+    for (int iy = 0; iy < nY; ++iy) cdf[iy] = TMath::Gamma(a, y[iy]);
+    double *row = &zTable[it*(nQ + 1)];
+    int iy = 0;
+    for (int k = 0; k <= nQ; ++k) {
+      // the last quantile is taken half a step inside, the tail is unbounded
+      double u = k < nQ ? (double)k/nQ : 1. - 0.5/nQ;
+      while (iy < nY - 1 && cdf[iy] < u) iy++;
+      double yk;
+      if (iy == 0)                 yk = 0.;
+      else if (cdf[iy] < u)        yk = y[nY - 1];
+      else {
+	double f = (u - cdf[iy-1])/(cdf[iy] - cdf[iy-1]);
+	yk = y[iy-1] + f*(y[iy] - y[iy-1]);
+      }
+      row[k] = exp(-yk);
+    }
+  }
+  printf("Bremsstrahlung tables: %d material budgets up to %g X0, %d quantiles\n", nT, tMax, nQ);
+}
+
+double BremsRetainedFraction(double t, double u)
+{
+  if (zTable.empty()) BuildTable();
+  if (t <= 0.) return 1.;
+  double xt = t/tMax*(nT - 1);
+  if (xt > nT - 1.001) xt = nT - 1.001;
+  int    it = (int)xt;
+  double wt = xt - it;
+  double xq = u*nQ;
+  int    k  = (int)xq;
+  if (k > nQ - 1) k = nQ - 1;
+  double wq = xq - k;
+  const double *row0 = &zTable[it*(nQ + 1) + k];
+  const double *row1 = row0 + nQ + 1;
+  return (1. - wt)*((1. - wq)*row0[0] + wq*row0[1]) + wt*((1. - wq)*row1[0] + wq*row1[1]);
+}
@@ -0,0 +1,14 @@
+#ifndef BREMSSTRAHLUNG_H
+#define BREMSSTRAHLUNG_H
+
+// Radiative energy loss of electrons in the material in front of the
+// tracking. After t radiation lengths the fraction z of its energy an
+// electron keeps follows the Bethe-Heitler distribution,
+// -ln z ~ Gamma(4t/3, 1), independent of the energy. Its inverse CDF is
+// tabulated on a grid of t once, so a draw costs four table lookups.
+
+// Fraction of the energy kept after t radiation lengths for the uniform
+// number u in (0,1); t above the table range is clamped to 0.5
+double BremsRetainedFraction(double t, double u);
+
+#endif
@@ -0,0 +1,186 @@
+#include "CaloGeometry.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "TMath.h"
+
+// One module: a plane of nX columns along phi and nZ rows along z at the
+// distance radius from the beam axis, facing azimuth phi. Column 0 and row 0
+// start at the local position xMin (along increasing phi) and zMin.
+
+struct CaloModule {
+  double phi;         // degrees
+  int    nX, nZ;
+  double xMin, zMin;  // cm
+};
+
+struct CaloLayout {
+  const char *name;
+  double radius;          // cm
+  double cellX, cellZ;    // cm
+  double phiMin, phiMax;  // degrees, range of the table
+  double sMax;            // table covers |sinh(eta)| < sMax
+  const CaloModule *module;
+  int    nModule;
+};
+
+// PHOS: modules of 64 crystals along phi by 56 along z, 2.2 cm at 460 cm,
+// i.e. 17.5 degrees and |eta| < 0.13 each; three modules and the half
+// module (32 columns) below them in phi. Modules are numbered in
+// increasing phi.
+static const CaloModule phosModule[] = {
+  {250., 32, 56,   0.0, -61.6},
+  {270., 64, 56, -70.4, -61.6},
+  {290., 64, 56, -70.4, -61.6},
+  {310., 64, 56, -70.4, -61.6},
+};
+
+// EMCAL: supermodules of 24 towers of 6 cm in phi at 428 cm, 1/3 ones of 8
+// towers at the upper edge. The projective towers along z are taken as a
+// uniform pitch spanning |eta| < 0.7. DCal: 2/3 supermodules on both sides
+// of PHOS, 0.22 < |eta| < 0.7, and 1/3 ones at full eta beyond it.
+static const CaloModule emcalModule[] = {
+  { 90.0, 24, 96, -72., -324.96},
+  {110.0, 24, 96, -72., -324.96},
+  {130.0, 24, 96, -72., -324.96},
+  {150.0, 24, 96, -72., -324.96},
+  {170.0, 24, 96, -72., -324.96},
+  {183.5,  8, 96, -24., -324.96},
+  {270.0, 24, 32, -72., -324.96},
+  {270.0, 24, 32, -72.,  108.32},
+  {290.0, 24, 32, -72., -324.96},
+  {290.0, 24, 32, -72.,  108.32},
+  {310.0, 24, 32, -72., -324.96},
+  {310.0, 24, 32, -72.,  108.32},
+  {323.5,  8, 96, -24., -324.96},
+};
+
+static const CaloLayout layout[kNCalo] = {
+  {"PHOS",  460., 2.2, 2.20, 245., 325., 0.14,
+   phosModule,  sizeof(phosModule)/sizeof(phosModule[0])},
+  {"EMCAL", 428., 6.0, 6.77,  75., 335., 0.78,
+   emcalModule, sizeof(emcalModule)/sizeof(emcalModule[0])},
+};
+
+// Cell of every (sinh(eta), phi) bin, -1 outside the modules
+
+struct CaloTable {
+  double sMin, ds, phiMin, dPhi;  // radians
+  int    nS, nPhi;
+  std::vector<int>  cell;         // nS x nPhi
+  std::vector<int>  firstCell;    // of each module
+  std::vector<char> dead;         // per cell
+};
+
+static CaloTable table[kNCalo];
+static bool tableReady = false;
+
+static void BuildTable(const CaloLayout &g, CaloTable &t)
+{
+  // four bins per cell side at eta = 0
+  t.ds     = g.cellZ/g.radius/4.;
+  t.dPhi   = g.cellX/g.radius/4.;
+  t.sMin   = -g.sMax;
+  t.phiMin = g.phiMin*TMath::DegToRad();
+  t.nS     = (int)ceil(2.*g.sMax/t.ds);
+  t.nPhi   = (int)ceil((g.phiMax - g.phiMin)*TMath::DegToRad()/t.dPhi);
+
+  int nCells = 0;
+  t.firstCell.resize(g.nModule);
+  for (int im = 0; im < g.nModule; ++im) {
+    t.firstCell[im] = nCells;
+    nCells += g.module[im].nX * g.module[im].nZ;
+  }
+  t.dead.assign(nCells, 0);
+  t.cell.assign(t.nS*t.nPhi, -1);
+
+  // ray from the origin through the bin centre, r = t (cos phi, sin phi, s)
+  for (int ip = 0; ip < t.nPhi; ++ip) {
+    double phi = t.phiMin + (ip + 0.5)*t.dPhi;
+    for (int im = 0; im < g.nModule; ++im) {
+      const CaloModule &m = g.module[im];
+      double delta = phi - m.phi*TMath::DegToRad();
+      if (cos(delta) <= 0.) continue;
+      double x = g.radius*tan(delta);
+      int ix = (int)floor((x - m.xMin)/g.cellX);
+      if (ix < 0 || ix >= m.nX) continue;
+      for (int is = 0; is < t.nS; ++is) {
+	double s = t.sMin + (is + 0.5)*t.ds;
+	double z = g.radius*s/cos(delta);
+	int iz = (int)floor((z - m.zMin)/g.cellZ);
+	if (iz < 0 || iz >= m.nZ) continue;
+	t.cell[is*t.nPhi + ip] = t.firstCell[im] + iz*m.nX + ix;
+      }
+    }
+  }
+  printf("Calorimeter geometry %s: %d modules, %d cells, table of %dx%d bins\n",
+	 g.name, g.nModule, nCells, t.nS, t.nPhi);
+}
+
+static void BuildTables()
+{
+  if (tableReady) return;
+  for (int ic = 0; ic < kNCalo; ++ic) BuildTable(layout[ic], table[ic]);
+  tableReady = true;
+}
+
+int CaloCell(int calo, const TLorentzVector &p, double zVertex)
+{
+  if (!tableReady) BuildTables();
+  const CaloTable &t = table[calo];
+  double pt = p.Pt();
+  if (pt <= 0.) return -1;
+  double s = p.Pz()/pt + zVertex/layout[calo].radius;
+  int is = (int)floor((s - t.sMin)/t.ds);
+  if (is < 0 || is >= t.nS) return -1;
+  double phi = atan2(p.Py(), p.Px());
+  if (phi < 0.) phi += TMath::TwoPi();
+  int ip = (int)floor((phi - t.phiMin)/t.dPhi);
+  if (ip < 0 || ip >= t.nPhi) return -1;
+  return t.cell[is*t.nPhi + ip];
+}
+
+bool IsCellLive(int calo, int cell)
+{
+  return cell >= 0 && !table[calo].dead[cell];
+}
+
+bool ReadDeadChannelMap(const char *fileName, std::string &cells)
+{
+  BuildTables();
+  FILE *f = fopen(fileName, "r");
+  if (!f) {
+    printf("Error: cannot read dead-channel map %s\n", fileName);
+    return false;
+  }
+  char line[256], name[64];
+  int nDead[kNCalo] = {0, 0};
+  int iLine = 0;
+  while (fgets(line, sizeof(line), f)) {
+    iLine++;
+    char *comment = strchr(line, '#');
+    if (comment) *comment = '\0';
+    int module, column, row;
+    int n = sscanf(line, "%63s %d %d %d", name, &module, &column, &row);
+    if (n <= 0) continue;
+    int calo = 0;
+    while (calo < kNCalo && strcmp(layout[calo].name, name)) calo++;
+    if (n != 4 || calo == kNCalo || module < 0 || module >= layout[calo].nModule ||
+	column < 0 || column >= layout[calo].module[module].nX ||
+	row < 0 || row >= layout[calo].module[module].nZ) {
+      printf("Error: %s, line %d: not a cell \"PHOS|EMCAL <module> <column> <row>\"\n",
+	     fileName, iLine);
+      fclose(f);
+      return false;
+    }
+    const CaloModule &m = layout[calo].module[module];
+    table[calo].dead[table[calo].firstCell[module] + row*m.nX + column] = 1;
+    nDead[calo]++;
+    sprintf(line, "%s %d %d %d\n", name, module, column, row);
+    cells += line;
+  }
+  fclose(f);
+  printf("Dead-channel map %s: %d PHOS and %d EMCAL cells\n", fileName, nDead[kPHOS], nDead[kEMCAL]);
+  return true;
+}
@@ -0,0 +1,34 @@
+#ifndef CALOGEOMETRY_H
+#define CALOGEOMETRY_H
+
+#include <string>
+#include "TLorentzVector.h"
+
+// Cell geometry of PHOS and of EMCAL with DCal. Every module is a flat
+// plane of cells facing the beam axis; the gaps between modules and the
+// PHOS hole of DCal follow from the module positions.
+//
+// The geometry is ray-traced once into a table per calorimeter over
+// (sinh(eta), phi) seen from the nominal interaction point, holding the cell
+// of every table bin, four bins per cell side. A vertex at z = zVertex
+// shifts sinh(eta) = pz/pT by zVertex/R, so an acceptance check is a
+// division, an atan2 and two lookups. Cell boundaries are exact to half a
+// table bin, 1/8 of a cell.
+
+enum CaloId {
+  kPHOS,
+  kEMCAL,  // EMCAL and DCal
+  kNCalo
+};
+
+// Cell hit by a particle of momentum p from (0, 0, zVertex) [cm], -1 if it
+// misses all modules. Cells are numbered module by module.
+int  CaloCell(int calo, const TLorentzVector &p, double zVertex);
+bool IsCellLive(int calo, int cell);
+
+// Dead-channel map: lines "PHOS|EMCAL <module> <column> <row>", columns
+// along phi and rows along z counted from 0, '#' starts a comment. The
+// cells read are appended to cells in canonical form for the settings.
+bool ReadDeadChannelMap(const char *fileName, std::string &cells);
+
+#endif
@@ -0,0 +1,70 @@
+#include "ConversionMap.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Material layers at eta = 0 (radiation lengths), radii in cm
+
+struct MaterialLayer {
+  double rMin, rMax, x0;
+};
+
+static const MaterialLayer layer[] = {
+  {  2.8,   3.0, 0.0022},  // beryllium beam pipe
+  {  3.8,   4.2, 0.0114},  // SPD layer 1
+  {  7.0,   7.6, 0.0114},  // SPD layer 2
+  { 11.0,  11.5, 0.0050},  // SPD thermal shield
+  { 14.6,  15.3, 0.0113},  // SDD layer 3
+  { 23.6,  24.3, 0.0126},  // SDD layer 4
+  { 27.0,  28.0, 0.0060},  // SDD/SSD thermal shield
+  { 37.8,  38.6, 0.0083},  // SSD layer 5
+  { 42.6,  43.4, 0.0086},  // SSD layer 6
+  { 48.0,  50.0, 0.0040},  // ITS services
+  { 60.0,  80.0, 0.0080},  // TPC inner containment and field cage
+  { 80.0, 180.0, 0.0032},  // TPC gas, Ne-CO2-N2
+};
+static const int nLayer = sizeof(layer)/sizeof(layer[0]);
+
+static const double rStep = 0.1;   // cm
+static const double rMax  = 180.;  // both legs still tracked in the TPC
+static const int    nInv  = 4096;
+static double tTotal = -1.;        // budget out to rMax
+static std::vector<double> rOfT;   // radius at t = tTotal*k/nInv
+
+static void BuildMap()
+{
+  // cumulative budget on a fine radial grid, layers spread uniformly
+  int nR = (int)(rMax/rStep + 0.5);
+  std::vector<double> tCum(nR + 1, 0.);
+  for (int ir = 1; ir <= nR; ++ir) {
+    double r0 = (ir - 1)*rStep, r1 = ir*rStep;
+    double dt = 0.;
+    for (int il = 0; il < nLayer; ++il) {
+      double overlap = fmin(r1, layer[il].rMax) - fmax(r0, layer[il].rMin);
+      if (overlap > 0.) dt += layer[il].x0*overlap/(layer[il].rMax - layer[il].rMin);
+    }
+    tCum[ir] = tCum[ir-1] + dt;
+  }
+  tTotal = tCum[nR];
+
+  rOfT.resize(nInv + 1);
+  int ir = 0;
+  for (int k = 0; k <= nInv; ++k) {
+    double t = tTotal*k/nInv;
+    while (ir < nR && tCum[ir+1] < t) ir++;
+    double dt = ir < nR ? tCum[ir+1] - tCum[ir] : 0.;
+    rOfT[k] = dt > 0. ? (ir + (t - tCum[ir])/dt)*rStep : ir*rStep;
+  }
+  printf("Conversion material map: %.2f%% X0 out to %g cm at eta = 0\n", 100.*tTotal, rMax);
+}
+
+double ConversionRadius(double pOverPt, double u)
+{
+  if (tTotal < 0.) BuildMap();
+  // budget at which the photon converts, along the radial direction
+  double t = -9./7.*log(1. - u)/pOverPt;
+  if (t >= tTotal) return -1.;
+  double x = t/tTotal*nInv;
+  int    k = (int)x;
+  return rOfT[k] + (x - k)*(rOfT[k+1] - rOfT[k]);
+}
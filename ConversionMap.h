@@ -0,0 +1,23 @@
+#ifndef CONVERSIONMAP_H
+#define CONVERSIONMAP_H
+
+#include "Rtypes.h"
+
+// Radial material map of the ALICE inner detectors for photon conversions
+// (PCM): beam pipe, ITS layers, TPC inner vessel and the TPC gas out to the
+// last radius where both conversion legs are still tracked. A photon
+// converts after t radiation lengths with probability 1 - exp(-7t/9).
+// The cumulative budget is inverted once into a table of radius against
+// t, so a conversion point is a logarithm and two table lookups.
+
+// Conversion radius [cm] for the uniform number u in (0,1), or -1 if the
+// photon leaves the tracking volume unconverted. The path through the
+// layers grows as p/pT of the photon.
+double ConversionRadius(double pOverPt, double u);
+
+// Particle index of the conversion legs of photon i in RandomKey:
+// i + kConversionElectron and i + kConversionPositron
+const UInt_t kConversionElectron = 0x40000000;
+const UInt_t kConversionPositron = 0x60000000;
+
+#endif
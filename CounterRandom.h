@@ -0,0 +1,95 @@
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+#include "Rtypes.h"
+#include <math.h>
+
+// Counter-based random numbers for the smearing (Philox4x32-10, Salmon et
+// al., SC'11). A draw is a pure function of (run seed, event number,
+// particle index, purpose, draw number), so any candidate is smeared
+// identically whatever else was smeared before it, in any order and from
+// any worker. There is no shared generator state.
+
+struct RandomKey {
+  ULong64_t seed;      // run seed
+  UInt_t    event;     // event number
+  UInt_t    particle;  // particle index in the event record
+};
+
+// Purpose of a draw: each purpose is an independent stream, so adding draws
+// of one kind never shifts the others
+enum RandomPurpose {
+  kRndmEnergy     = 1,  // calorimeter energy
+  kRndmMomentum   = 2,  // track momentum
+  kRndmDirection  = 3,  // photon direction at the calorimeter
+  kRndmCoordinate = 4,  // photon coordinate
+  kRndmPileup     = 5,  // number, choice and rotation of pileup collisions
+  kRndmBrems      = 6,  // bremsstrahlung energy loss
+  kRndmConversion = 7   // photon conversion point and pair energy sharing
+};
+
+class RandomStream {
+ public:
+  RandomStream(const RandomKey &key, UInt_t purpose) : fBlock(0), fNext(4), fHaveSpare(false) {
+    fKey[0] = (UInt_t)(key.seed);
+    fKey[1] = (UInt_t)(key.seed >> 32);
+    fCtr[0] = key.event;
+    fCtr[1] = key.particle;
+    fCtr[2] = purpose;
+  }
+
+  // Uniform in the open interval (0,1)
+  Double_t Rndm() {
+    if (fNext == 4) {
+      UInt_t ctr[4] = {fCtr[0], fCtr[1], fCtr[2], fBlock++};
+      Philox(ctr, fKey, fOut);
+      fNext = 0;
+    }
+    return (fOut[fNext++] + 0.5) * (1./4294967296.);
+  }
+
+  // Gaussian by the Box-Muller method, two values per pair of uniforms
+  Double_t Gaus(Double_t mean = 0., Double_t sigma = 1.) {
+    if (fHaveSpare) {
+      fHaveSpare = false;
+      return mean + sigma * fSpare;
+    }
+    Double_t r   = sqrt(-2. * log(Rndm()));
+    Double_t phi = 2. * M_PI * Rndm();
+    fSpare     = r * sin(phi);
+    fHaveSpare = true;
+    return mean + sigma * r * cos(phi);
+  }
+
+  // Philox4x32 with 10 rounds: out = bijection of ctr under key
+  static void Philox(const UInt_t *ctr, const UInt_t *key, UInt_t *out) {
+    const UInt_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    const UInt_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+    UInt_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    UInt_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      ULong64_t p0 = (ULong64_t)M0 * c0;
+      ULong64_t p1 = (ULong64_t)M1 * c2;
+      UInt_t n0 = (UInt_t)(p1 >> 32) ^ c1 ^ k0;
+      UInt_t n2 = (UInt_t)(p0 >> 32) ^ c3 ^ k1;
+      c1 = (UInt_t)p1;
+      c3 = (UInt_t)p0;
+      c0 = n0;
+      c2 = n2;
+      k0 += W0;
+      k1 += W1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+  }
+
+ private:
+  UInt_t   fKey[2];
+  UInt_t   fCtr[3];
+  UInt_t   fBlock;    // fourth counter word, one block per four uniforms
+  UInt_t   fOut[4];
+  int      fNext;     // next unused word of fOut
+  bool     fHaveSpare;
+  Double_t fSpare;
+};
+
+#endif
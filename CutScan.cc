@@ -0,0 +1,140 @@
+#include "CutScan.h"
+#include "StageProfile.h"
+#include <cstdio>
+
+using namespace Pythia8;
+
+// Grid of thresholds: 20 bins per cut variable, 0.25 GeV for the tracks
+// and 0.5 GeV for the photons, so that all cut values used so far (0.5,
+// 1.0, 1.5, 2.0 GeV and 5.0 GeV for the photons) are bin edges
+
+static const int    nScanBins[kScanVars] = {20,  20,  20};
+static const double scanMin  [kScanVars] = {0.,  0.,  0.};
+static const double scanMax  [kScanVars] = {5.,  5.,  10.};
+static const char  *scanTitle[kScanVars] = {"track p_{T}^{min} (GeV/c)",
+					    "track E^{min} (GeV)",
+					    "#gamma E^{min} (GeV)"};
+static const char  *cndtnTag [kScanCndtn] = {"CTS", "EMCAL"};
+
+void BookCutScan(const SpeciesTable &table, CutScan &scan, const char *suffix)
+{
+  char name[256], title[256];
+
+  for (int ic = 0; ic < kScanCndtn; ++ic) {
+    scan.hYield[ic].clear();
+    for (size_t is = 0; is < table.species.size(); ++is) {
+      const Species &sp = table.species[is];
+      sprintf(name,  "hScan_%s_%s%s", cndtnTag[ic], sp.name.c_str(), suffix);
+      sprintf(title, "%s yield vs thresholds, tracks in %s", sp.title.c_str(), cndtnTag[ic]);
+      THnF *h = new THnF(name, title, kScanVars, nScanBins, scanMin, scanMax);
+      for (int iv = 0; iv < kScanVars; ++iv) h->GetAxis(iv)->SetTitle(scanTitle[iv]);
+      h->Sumw2();
+      scan.hYield[ic].push_back(h);
+    }
+
+    scan.hMassDiff[ic].clear();
+    for (size_t ig = 0; ig < table.massGroup.size(); ++ig) {
+      const MassGroup &g = table.massGroup[ig];
+      int    nBins[kScanVars+1] = {g.nDiffBins};
+      double xMin [kScanVars+1] = {g.diffMin};
+      double xMax [kScanVars+1] = {g.diffMax};
+      for (int iv = 0; iv < kScanVars; ++iv) {
+	nBins[iv+1] = nScanBins[iv];
+	xMin [iv+1] = scanMin[iv];
+	xMax [iv+1] = scanMax[iv];
+      }
+      sprintf(name,  "hScan_%s_%s_mass_diff%s", cndtnTag[ic], g.allName.c_str(), suffix);
+      sprintf(title, "#Delta M vs thresholds, tracks in %s", cndtnTag[ic]);
+      THnF *h = new THnF(name, title, kScanVars+1, nBins, xMin, xMax);
+      h->GetAxis(0)->SetTitle("#Delta M (GeV/c^{2})");
+      for (int iv = 0; iv < kScanVars; ++iv) h->GetAxis(iv+1)->SetTitle(scanTitle[iv]);
+      h->Sumw2();
+      scan.hMassDiff[ic].push_back(h);
+    }
+  }
+
+  return;
+}
+
+void FillCutScan(CutScan &scan, int iSpecies, int iMassGroup, const bool *inAcc,
+		 const double *cutVar, double massDiff, double br)
+{
+  PROFILE_STAGE(kStageFill);
+  double x[kScanVars+1];
+  x[0] = massDiff;
+  for (int iv = 0; iv < kScanVars; ++iv) x[iv+1] = cutVar[iv];
+
+  for (int ic = 0; ic < kScanCndtn; ++ic) {
+    if (!inAcc[ic]) continue;
+    scan.hYield[ic][iSpecies]    ->Fill(cutVar, br);
+    scan.hMassDiff[ic][iMassGroup]->Fill(x, br);
+  }
+
+  return;
+}
+
+// Replace the contents along the cut axes (all axes from firstCut on) by
+// the sum over all bins above, overflow included
+
+static void Cumulate(THnBase *h, int firstCut)
+{
+  const int nDim = h->GetNdimensions();
+  std::vector<int> nCells(nDim), idx(nDim);
+  Long64_t nTotal = 1;
+  for (int id = 0; id < nDim; ++id) {
+    nCells[id] = h->GetAxis(id)->GetNbins() + 2;
+    nTotal *= nCells[id];
+  }
+
+  for (int iCut = firstCut; iCut < nDim; ++iCut) {
+    for (Long64_t iCell = 0; iCell < nTotal; ++iCell) {
+      // decode the cell; walk each line of the cut axis once, from its start
+      Long64_t rest = iCell;
+      for (int id = 0; id < nDim; ++id) {
+	idx[id] = rest % nCells[id];
+	rest   /= nCells[id];
+      }
+      if (idx[iCut] != 0) continue;
+
+      double sum = 0., sum2 = 0.;
+      for (int ib = nCells[iCut] - 1; ib >= 1; --ib) {
+	idx[iCut] = ib;
+	Long64_t bin = h->GetBin(&idx[0]);
+	sum  += h->GetBinContent(bin);
+	sum2 += h->GetBinError2(bin);
+	h->SetBinContent(&idx[0], sum);
+	h->SetBinError2(bin, sum2);
+      }
+    }
+  }
+
+  return;
+}
+
+void CumulateCutScan(CutScan &scan)
+{
+  for (int ic = 0; ic < kScanCndtn; ++ic) {
+    for (size_t i = 0; i < scan.hYield[ic].size(); ++i)    Cumulate(scan.hYield[ic][i], 0);
+    for (size_t i = 0; i < scan.hMassDiff[ic].size(); ++i) Cumulate(scan.hMassDiff[ic][i], 1);
+  }
+
+  return;
+}
+
+void ScaleCutScan(CutScan &scan, double scale)
+{
+  for (int ic = 0; ic < kScanCndtn; ++ic)
+    for (size_t i = 0; i < scan.hYield[ic].size(); ++i) scan.hYield[ic][i]->Scale(scale);
+
+  return;
+}
+
+void WriteCutScan(CutScan &scan)
+{
+  for (int ic = 0; ic < kScanCndtn; ++ic) {
+    for (size_t i = 0; i < scan.hYield[ic].size(); ++i)    scan.hYield[ic][i]   ->Write();
+    for (size_t i = 0; i < scan.hMassDiff[ic].size(); ++i) scan.hMassDiff[ic][i]->Write();
+  }
+
+  return;
+}
@@ -0,0 +1,34 @@
+#ifndef CUTSCAN_H
+#define CUTSCAN_H
+
+#include <vector>
+#include "THn.h"
+#include "Species.h"
+
+// Cut-threshold scan. Every candidate that passes the geometric acceptance
+// is filled once at the values of its cut variables
+//   0: minimum track p_T   (CTS p_T cut)
+//   1: minimum track E     (electron p0 cut, EMCAL energy cut)
+//   2: minimum photon E    (PHOS energy cut, E_gamma > 2/5 GeV, PHOS trigger)
+// After the run the cut axes are integrated from above, so that the bin
+// with lower edges (a,b,c) holds the yield with p_T >= a, E >= b and
+// E_gamma >= c. A grid of thresholds is read out with no further passes.
+
+const int kScanVars  = 3;
+const int kScanCndtn = 2;  // 0: tracks in CTS, 1: tracks in EMCAL; photons in PHOS
+
+struct CutScan {
+  // per species and acceptance family, axes are the cut variables
+  std::vector<THnF*> hYield[kScanCndtn];
+  // per mass group and acceptance family, axis 0 is Delta M, then the cut variables
+  std::vector<THnF*> hMassDiff[kScanCndtn];
+};
+
+void BookCutScan(const SpeciesTable &table, CutScan &scan, const char *suffix);
+void FillCutScan(CutScan &scan, int iSpecies, int iMassGroup, const bool *inAcc,
+		 const double *cutVar, double massDiff, double br);
+void CumulateCutScan(CutScan &scan);
+void ScaleCutScan(CutScan &scan, double scale);
+void WriteCutScan(CutScan &scan);
+
+#endif
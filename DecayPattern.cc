@@ -0,0 +1,172 @@
+#include "DecayPattern.h"
+#include "StageProfile.h"
+#include <cstdlib>
+#include <cctype>
+
+using namespace Pythia8;
+
+// Pattern grammar:
+//   decay    := particle "->" item { item }
+//   item     := particle | "(" decay ")"
+//   particle := "X" | signed integer PDG code
+
+struct ParsedNode {
+  int id;
+  std::vector<ParsedNode> daughter;
+};
+
+static void SkipSpaces(const char *&s)
+{
+  while (isspace(*s)) s++;
+}
+
+static bool ParseParticle(const char *&s, int idMother, int &id)
+{
+  SkipSpaces(s);
+  if (*s == 'X') {
+    s++;
+    id = idMother;
+    return true;
+  }
+  char *end;
+  long value = strtol(s, &end, 10);
+  if (end == s) return false;
+  s = end;
+  id = value;
+  return true;
+}
+
+static bool ParseDecay(const char *&s, int idMother, ParsedNode &node)
+{
+  if (!ParseParticle(s, idMother, node.id)) return false;
+  SkipSpaces(s);
+  if (s[0] != '-' || s[1] != '>') return false;
+  s += 2;
+
+  while (true) {
+    SkipSpaces(s);
+    if (*s == '\0' || *s == ')') break;
+    ParsedNode daughter;
+    if (*s == '(') {
+      s++;
+      if (!ParseDecay(s, idMother, daughter)) return false;
+      SkipSpaces(s);
+      if (*s != ')') return false;
+      s++;
+    } else {
+      if (!ParseParticle(s, idMother, daughter.id)) return false;
+    }
+    node.daughter.push_back(daughter);
+  }
+  return !node.daughter.empty();
+}
+
+static bool MatchNode(const Event &event, int i, const DecayPattern &pattern,
+		      int k, std::vector<int> &iNode);
+
+// Assign pattern daughters j, j+1, ... of node k to the event daughters
+// starting at index d1 that are not yet marked in the mask used.
+static bool MatchDaughters(const Event &event, int d1, const DecayPattern &pattern,
+			   int k, int j, unsigned used, std::vector<int> &iNode)
+{
+  const DecayNode &node = pattern.node[k];
+  if (j == node.nDaughters) return true;
+  for (int m = 0; m < node.nDaughters; ++m) {
+    if (used & (1u << m)) continue;
+    if (MatchNode(event, d1 + m, pattern, node.first + j, iNode) &&
+        MatchDaughters(event, d1, pattern, k, j + 1, used | (1u << m), iNode))
+      return true;
+  }
+  return false;
+}
+
+static bool MatchNode(const Event &event, int i, const DecayPattern &pattern,
+		      int k, std::vector<int> &iNode)
+{
+  const DecayNode &node = pattern.node[k];
+  if (event[i].id() != node.id) return false;
+  iNode[k] = i;
+  if (node.nDaughters == 0) return true;
+
+  // daughters must be stored contiguously, as for all 2-body decays
+  int d1 = event[i].daughter1();
+  int d2 = event[i].daughter2();
+  if (d2 == 0) d2 = d1;
+  if (d1 <= 0 || d2 - d1 + 1 != node.nDaughters) return false;
+
+  return MatchDaughters(event, d1, pattern, k, 0, 0u, iNode);
+}
+
+bool CompileDecayPattern(const char *text, int idMother, DecayPattern &pattern)
+{
+  const char *s = text;
+  ParsedNode root;
+  if (!ParseDecay(s, idMother, root)) return false;
+  SkipSpaces(s);
+  if (*s != '\0') return false;
+
+  pattern.text = text;
+  pattern.node.clear();
+  pattern.leaf.clear();
+  pattern.resonance = -1;
+
+  // Flatten the tree breadth first, keeping daughters contiguous
+  std::vector<const ParsedNode*> queue;
+  queue.push_back(&root);
+  DecayNode top = {root.id, 0, 0};
+  pattern.node.push_back(top);
+  for (size_t k = 0; k < queue.size(); ++k) {
+    const ParsedNode *parsed = queue[k];
+    if (parsed->daughter.size() > 8*sizeof(unsigned)) return false;
+    pattern.node[k].first      = pattern.node.size();
+    pattern.node[k].nDaughters = parsed->daughter.size();
+    for (size_t j = 0; j < parsed->daughter.size(); ++j) {
+      DecayNode node = {parsed->daughter[j].id, 0, 0};
+      pattern.node.push_back(node);
+      queue.push_back(&parsed->daughter[j]);
+    }
+  }
+
+  // Final legs in the order they were written
+  std::vector<int> stack(1, 0);
+  while (!stack.empty()) {
+    int k = stack.back();
+    stack.pop_back();
+    const DecayNode &node = pattern.node[k];
+    if (node.nDaughters == 0) {
+      pattern.leaf.push_back(k);
+      continue;
+    }
+    for (int j = node.nDaughters - 1; j >= 0; --j)
+      stack.push_back(node.first + j);
+  }
+
+  for (int j = 0; j < pattern.node[0].nDaughters; ++j) {
+    if (pattern.node[pattern.node[0].first + j].nDaughters > 0) {
+      pattern.resonance = pattern.node[0].first + j;
+      break;
+    }
+  }
+
+  pattern.inResonance.assign(pattern.node.size(), false);
+  if (pattern.resonance >= 0) {
+    stack.assign(1, pattern.resonance);
+    while (!stack.empty()) {
+      int k = stack.back();
+      stack.pop_back();
+      pattern.inResonance[k] = true;
+      for (int j = 0; j < pattern.node[k].nDaughters; ++j)
+	stack.push_back(pattern.node[k].first + j);
+    }
+  }
+
+  return true;
+}
+
+bool MatchDecayPattern(const Event &event, int iMother,
+		       const DecayPattern &pattern, std::vector<int> &iNode)
+{
+  PROFILE_STAGE(kStageMatch);
+  iNode.resize(pattern.node.size());
+  return MatchNode(event, iMother, pattern, 0, iNode);
+}
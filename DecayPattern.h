@@ -0,0 +1,34 @@
+#ifndef DECAYPATTERN_H
+#define DECAYPATTERN_H
+
+#include <string>
+#include <vector>
+#include "Pythia8/Pythia.h"
+
+// Compiled decay-tree pattern, e.g. "X -> (443 -> 11 -11) 22".
+// X is a placeholder for the mother id given at compilation time.
+// Nodes are stored breadth first, so the daughters of node k are the nodes
+// first ... first+nDaughters-1 and node 0 is always the mother.
+
+struct DecayNode {
+  int id;         // PDG code required for this node
+  int first;      // index of the first daughter node
+  int nDaughters; // number of daughter nodes, 0 for a final leg
+};
+
+struct DecayPattern {
+  std::string            text;      // pattern as written by the user
+  std::vector<DecayNode> node;      // compiled tree
+  std::vector<int>       leaf;      // node indices of the final legs, in pattern order
+  int                    resonance; // first decaying daughter of the mother, -1 if none
+  std::vector<bool>      inResonance; // per node, true for the resonance and its descendants
+};
+
+bool CompileDecayPattern(const char *text, int idMother, DecayPattern &pattern);
+
+// Match the decay chain of event[iMother] against the pattern. On success
+// iNode[k] holds the event index of the particle matched to node k.
+bool MatchDecayPattern(const Pythia8::Event &event, int iMother,
+		       const DecayPattern &pattern, std::vector<int> &iNode);
+
+#endif
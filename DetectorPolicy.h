@@ -0,0 +1,225 @@
+#ifndef DETECTORPOLICY_H
+#define DETECTORPOLICY_H
+
+#include "TLorentzVector.h"
+#include "CounterRandom.h"
+#include "StageProfile.h"
+#include "Bremsstrahlung.h"
+#include "ConversionMap.h"
+#include "TMath.h"
+#include <math.h>
+
+// Detector response policies. A detector scenario combines one policy of
+// each kind, Detector<EnergyRes,MomentumRes,PositionRes,Material>, and the
+// smearing templates below are instantiated per scenario: constants fold
+// at compile time and ideal components skip their random draws. All draws
+// come from counter-based streams keyed by (run seed, event, particle,
+// purpose).
+
+// Photon energy resolution, sigma_E/E = sqrt(a^2/E^2 + b^2/E + c^2)
+
+struct PhosEnergyRes {
+  static const bool ideal = false;
+  static Double_t SigmaE(Double_t E) {
+    const Double_t a = 0.018, b = 0.033, c = 0.011; // Energy resolution of ALICE PHOS
+    return E * sqrt(a*a/E/E + b*b/E + c*c);
+  }
+};
+
+struct IdealEnergyRes {
+  static const bool ideal = true;
+  static Double_t SigmaE(Double_t) { return 0.; }
+};
+
+// Track momentum resolution, sigma_p/p = sqrt(a^2 + (b*p)^2)
+
+struct TrackMomentumRes {
+  static const bool ideal = false;
+  static Double_t SigmaP(Double_t P) {
+    const Double_t a=0.008, b=0.002; // Momentum resolution of ALICE treaking system
+    return P * sqrt(a*a + b*P*b*P);
+  }
+};
+
+struct IdealMomentumRes {
+  static const bool ideal = true;
+  static Double_t SigmaP(Double_t) { return 0.; }
+};
+
+// Photon coordinate resolution sigma_x = sqrt(a^2 + b^2/E) [cm] of a
+// calorimeter at the distance Radius() [cm] from the interaction point
+
+struct PhosPosition {
+  static const bool ideal = false;
+  static Double_t Radius() { return 460.; } // PHOS distance from beam interaction point
+  static Double_t SigmaX(Double_t E) {
+    const Double_t a = 0.15, b = 0.25; // realistic coordinate resolution in PHOS
+    return sqrt(a*a + b*b/E);
+  }
+};
+
+struct PprPosition {
+  static const bool ideal = false;
+  static Double_t Radius() { return 460.; }
+  static Double_t SigmaX(Double_t E) {
+    const Double_t a = 0.096, b = 0.229; // PPR vol.II, tab.5.17
+    return sqrt(a*a + b*b/E);
+  }
+};
+
+struct AnghiePosition {
+  static const bool ideal = false;
+  static Double_t Radius() { return 150.; } // ANGHIE CALO distance from beam interaction point
+  static Double_t SigmaX(Double_t E) {
+    const Double_t a = 0.15, b = 0.25;
+    return sqrt(a*a + b*b/E);
+  }
+};
+
+struct IdealPosition {
+  static const bool ideal = true;
+  static Double_t Radius() { return 460.; }
+  static Double_t SigmaX(Double_t) { return 0.; }
+};
+
+// Material in front of the tracking, X0() radiation lengths at eta = 0.
+// Photon conversions use the radial map of ConversionMap.cc instead.
+
+struct ItsTpcMaterial {
+  static const bool ideal = false;
+  static Double_t X0() { return 0.08; } // beam pipe, ITS and TPC inner vessel
+};
+
+struct NoMaterial {
+  static const bool ideal = true;
+  static Double_t X0() { return 0.; }
+};
+
+template <class EnergyRes, class MomentumRes, class PositionRes, class MaterialBudget = ItsTpcMaterial>
+struct Detector {
+  typedef EnergyRes      Energy;
+  typedef MomentumRes    Momentum;
+  typedef PositionRes    Position;
+  typedef MaterialBudget Material;
+};
+
+// The reference detector used by smearE(), resolutionPhoton() etc.
+typedef Detector<PhosEnergyRes, TrackMomentumRes, PhosPosition> RealisticDetector;
+
+template <class EnergyRes>
+Double_t SmearEnergy(Double_t Etrue, const RandomKey &key)
+{
+  if (EnergyRes::ideal) return Etrue;
+  RandomStream rndm(key, kRndmEnergy);
+  Double_t Esmeared = rndm.Gaus(Etrue, EnergyRes::SigmaE(Etrue));
+  if (Esmeared<0) Esmeared = 0;
+  return Esmeared;
+}
+
+template <class MomentumRes>
+Double_t SmearMomentum(Double_t Ptrue, const RandomKey &key)
+{
+  if (MomentumRes::ideal) return Ptrue;
+  RandomStream rndm(key, kRndmMomentum);
+  Double_t Psmeared = rndm.Gaus(Ptrue, MomentumRes::SigmaP(Ptrue));
+  if (Psmeared<0) Psmeared = 0;
+  return Psmeared;
+}
+
+template <class PositionRes>
+Double_t SmearCoordinate(Double_t xTrue, Double_t E, const RandomKey &key)
+{
+  if (PositionRes::ideal) return xTrue;
+  RandomStream rndm(key, kRndmCoordinate);
+  return rndm.Gaus(xTrue, PositionRes::SigmaX(E));
+}
+
+// Smeared photon 4-momentum: smeared energy, direction smeared by the
+// coordinate resolution at the calorimeter surface
+
+template <class EnergyRes, class PositionRes>
+TLorentzVector SmearPhoton(TLorentzVector pTrue, const RandomKey &key)
+{
+  PROFILE_STAGE(kStageSmear);
+  Double_t Etrue = pTrue.E();
+  Double_t Esmeared = SmearEnergy<EnergyRes>(Etrue, key);
+  Double_t phi   = pTrue.Phi();
+  Double_t theta = pTrue.Theta();
+  if (!PositionRes::ideal) {
+    RandomStream rndm(key, kRndmDirection);
+    Double_t sigmaAngle = PositionRes::SigmaX(Etrue)/PositionRes::Radius();
+    phi   += rndm.Gaus(0.,sigmaAngle);
+    theta += rndm.Gaus(0.,sigmaAngle);
+  }
+  Double_t pxSmeared = Esmeared*TMath::Cos(phi)*TMath::Sin(theta);
+  Double_t pySmeared = Esmeared*TMath::Sin(phi)*TMath::Sin(theta);
+  Double_t pzSmeared = Esmeared*TMath::Cos(theta);
+  return TLorentzVector(pxSmeared,pySmeared,pzSmeared,Esmeared);
+}
+
+// Electron 4-momentum after the bremsstrahlung in the material, direction
+// kept; the path through the material grows as p/pT. A leg along the beam
+// (pT = 0) never reaches the detector and is returned as it is.
+
+template <class Material>
+TLorentzVector RadiateElectron(TLorentzVector pTrue, const RandomKey &key)
+{
+  if (Material::ideal || pTrue.Pt() <= 0.) return pTrue;
+  PROFILE_STAGE(kStageSmear);
+  RandomStream rndm(key, kRndmBrems);
+  Double_t z = BremsRetainedFraction(Material::X0()*pTrue.P()/pTrue.Pt(), rndm.Rndm());
+  Double_t Mass = pTrue.M();
+  Double_t p3 = z*pTrue.E();
+  p3 = p3 > Mass ? sqrt(p3*p3 - Mass*Mass)/pTrue.P() : 0.;
+  return TLorentzVector(pTrue.Px()*p3, pTrue.Py()*p3, pTrue.Pz()*p3, TMath::Max(z*pTrue.E(), Mass));
+}
+
+// Smeared track 4-momentum: smeared absolute momentum, true direction and mass
+
+template <class MomentumRes>
+TLorentzVector SmearTrack(TLorentzVector pTrue, const RandomKey &key)
+{
+  PROFILE_STAGE(kStageSmear);
+  Double_t Mass = pTrue.M();
+  Double_t p3True = pTrue.P();
+  Double_t p3Smeared = SmearMomentum<MomentumRes>(p3True, key);
+  Double_t pxSmeared = pTrue.Px() * p3Smeared/p3True;
+  Double_t pySmeared = pTrue.Py() * p3Smeared/p3True;
+  Double_t pzSmeared = pTrue.Pz() * p3Smeared/p3True;
+  Double_t Esmeared = sqrt(p3Smeared*p3Smeared + Mass*Mass);
+  return TLorentzVector(pxSmeared,pySmeared,pzSmeared,Esmeared);
+}
+
+// Photon reconstructed from its conversion pair (PCM): the photon converts
+// in the material at a radius drawn from the conversion map, the energy is
+// shared between e- and e+ by the high-energy Bethe-Heitler spectrum, both
+// legs are taken collinear with the photon and smeared as tracks. False if
+// the photon does not convert within the tracking or a leg is lost, and for
+// a photon along the beam (pT = 0).
+
+template <class Material, class MomentumRes>
+bool ConvertPhoton(TLorentzVector pTrue, const RandomKey &key, double legPtMin, TLorentzVector &pPair)
+{
+  if (Material::ideal || pTrue.Pt() <= 0.) return false;
+  PROFILE_STAGE(kStageSmear);
+  RandomStream rndm(key, kRndmConversion);
+  if (ConversionRadius(pTrue.P()/pTrue.Pt(), rndm.Rndm()) < 0.) return false;
+  // d sigma/dx ~ 1 - 4/3 x(1-x), at least 2/3 of the maximum
+  Double_t x = rndm.Rndm();
+  while (rndm.Rndm() > 1. - 4./3.*x*(1. - x)) x = rndm.Rndm();
+  const Double_t Mass = 0.000511;
+  pPair = TLorentzVector();
+  for (int iLeg = 0; iLeg < 2; ++iLeg) {
+    Double_t E = TMath::Max((iLeg == 0 ? x : 1. - x)*pTrue.E(), Mass);
+    Double_t p3 = sqrt(E*E - Mass*Mass)/pTrue.P();
+    TLorentzVector pLeg(pTrue.Px()*p3, pTrue.Py()*p3, pTrue.Pz()*p3, E);
+    RandomKey legKey = key;
+    legKey.particle = key.particle + (iLeg == 0 ? kConversionElectron : kConversionPositron);
+    pLeg = SmearTrack<MomentumRes>(pLeg, legKey);
+    if (pLeg.Pt() < legPtMin || fabs(pLeg.Eta()) > 0.9) return false;
+    pPair += pLeg;
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,192 @@
+#include "EventQueue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+// Set the modification time of a file to now, optionally creating it
+
+static bool Touch(const std::string &path, bool create = false)
+{
+  if (create) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) return false;
+    close(fd);
+  }
+  return utime(path.c_str(), NULL) == 0;
+}
+
+// Current time of the file server. Leases are aged by modification times,
+// which the server sets, so clock skew between worker nodes does not matter.
+
+static time_t ServerTime(const EventQueue &queue)
+{
+  std::string path = queue.dir + "/clock." + queue.owner;
+  struct stat st;
+  if (Touch(path, true) && stat(path.c_str(), &st) == 0) return st.st_mtime;
+  return time(NULL);
+}
+
+static void ListDir(const std::string &path, std::vector<std::string> &names)
+{
+  names.clear();
+  DIR *dir = opendir(path.c_str());
+  if (!dir) return;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL)
+    if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+  closedir(dir);
+}
+
+static std::string LeaseName(const EventQueue &queue, const char *state, int chunk)
+{
+  char name[64];
+  sprintf(name, "/%s/%d@", state, chunk);
+  return queue.dir + name + queue.owner;
+}
+
+bool OpenEventQueue(const char *dir, EventQueue &queue)
+{
+  queue.dir          = dir;
+  queue.campaign     = -1;
+  queue.nChunks      = 0;
+  queue.chunkEvents  = 0;
+  queue.leaseTimeout = 0;
+
+  std::string config = queue.dir + "/queue";
+  FILE *f = fopen(config.c_str(), "r");
+  if (!f) {
+    printf("Error: cannot open event queue %s\n", config.c_str());
+    return false;
+  }
+  char line[256], key[64];
+  int value;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "%63s = %d", key, &value) != 2) continue;
+    if      (!strcmp(key, "campaign"))     queue.campaign     = value;
+    else if (!strcmp(key, "chunks"))       queue.nChunks      = value;
+    else if (!strcmp(key, "chunkEvents"))  queue.chunkEvents  = value;
+    else if (!strcmp(key, "leaseTimeout")) queue.leaseTimeout = value;
+  }
+  fclose(f);
+  if (queue.campaign < 0 || queue.nChunks <= 0 || queue.chunkEvents <= 0 || queue.leaseTimeout <= 0) {
+    printf("Error: event queue %s needs campaign, chunks, chunkEvents and leaseTimeout\n", config.c_str());
+    return false;
+  }
+
+  char host[256];
+  if (gethostname(host, sizeof(host)) != 0) strcpy(host, "unknown");
+  host[sizeof(host)-1] = 0;
+  sprintf(line, ".%d", (int)getpid());
+  queue.owner     = std::string(host) + line;
+  queue.held.clear();
+  queue.lastRenew = time(NULL);
+
+  printf("Event queue %s: campaign %d, %d chunks of %d events, job %s\n",
+	 dir, queue.campaign, queue.nChunks, queue.chunkEvents, queue.owner.c_str());
+  return true;
+}
+
+// Lease the next chunk: an untaken one if any is left, else one whose lease
+// has expired. Returns false when there is no work left for this job.
+
+bool LeaseChunk(EventQueue &queue, int &chunk)
+{
+  std::vector<std::string> names;
+
+  // start at a job-dependent place so that jobs rarely race for one file
+  ListDir(queue.dir + "/todo", names);
+  size_t start = names.empty() ? 0 : (size_t)getpid() % names.size();
+  for (size_t k = 0; k < names.size(); ++k) {
+    std::string todo = queue.dir + "/todo/" + names[(start + k) % names.size()];
+    int c = atoi(names[(start + k) % names.size()].c_str());
+    // touch before the rename, so the new lease never looks expired
+    if (!Touch(todo)) continue;
+    if (rename(todo.c_str(), LeaseName(queue, "leased", c).c_str()) == 0) {
+      queue.held.push_back(c);
+      chunk = c;
+      return true;
+    }
+  }
+
+  ListDir(queue.dir + "/leased", names);
+  time_t now = ServerTime(queue);
+  for (size_t k = 0; k < names.size(); ++k) {
+    size_t at = names[k].find('@');
+    if (at == std::string::npos || names[k].substr(at+1) == queue.owner) continue;
+    std::string lease = queue.dir + "/leased/" + names[k];
+    struct stat st;
+    if (stat(lease.c_str(), &st) != 0 || now - st.st_mtime <= queue.leaseTimeout) continue;
+    int c = atoi(names[k].c_str());
+    if (!Touch(lease)) continue;
+    if (rename(lease.c_str(), LeaseName(queue, "leased", c).c_str()) == 0) {
+      printf("Event queue: took over expired lease %s\n", names[k].c_str());
+      queue.held.push_back(c);
+      chunk = c;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Touch all leases of this job, at most every leaseTimeout/4 seconds unless
+// forced, so it is cheap to call once per event. A lease that is gone was
+// taken over by another job after this one stalled: the job must not write
+// its output, or the chunk's events would be counted twice (mergeCampaign.sh
+// refuses such a campaign).
+
+bool RenewLeases(EventQueue &queue, bool force)
+{
+  time_t now = time(NULL);
+  if (!force && now - queue.lastRenew < queue.leaseTimeout/4) return true;
+  queue.lastRenew = now;
+
+  bool ok = true;
+  for (size_t k = 0; k < queue.held.size(); ) {
+    if (Touch(LeaseName(queue, "leased", queue.held[k]))) {
+      ++k;
+      continue;
+    }
+    printf("Error: lease on chunk %d was taken over by another job\n", queue.held[k]);
+    queue.held.erase(queue.held.begin() + k);
+    ok = false;
+  }
+  return ok;
+}
+
+// Mark the chunks of this job done, after its output has been written
+
+bool CompleteLeases(EventQueue &queue)
+{
+  bool ok = RenewLeases(queue, true);
+  for (size_t k = 0; k < queue.held.size(); ++k) {
+    if (rename(LeaseName(queue, "leased", queue.held[k]).c_str(),
+	       LeaseName(queue, "done",   queue.held[k]).c_str()) != 0) {
+      printf("Error: cannot mark chunk %d done\n", queue.held[k]);
+      ok = false;
+    }
+  }
+  queue.held.clear();
+  unlink((queue.dir + "/clock." + queue.owner).c_str());
+  return ok;
+}
+
+// Put the chunks of this job back into todo, for a job whose output is lost;
+// a chunk that cannot be moved is taken over once its lease expires
+
+void ReleaseLeases(EventQueue &queue)
+{
+  for (size_t k = 0; k < queue.held.size(); ++k) {
+    char todo[64];
+    sprintf(todo, "/todo/%d", queue.held[k]);
+    if (rename(LeaseName(queue, "leased", queue.held[k]).c_str(), (queue.dir + todo).c_str()) == 0)
+      printf("Event queue: chunk %d given back\n", queue.held[k]);
+  }
+  queue.held.clear();
+  unlink((queue.dir + "/clock." + queue.owner).c_str());
+}
@@ -0,0 +1,43 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+// Queue of event chunks shared by the batch jobs of one campaign through a
+// directory on the shared file system (see batch/makeQueue.sh):
+//
+//   <dir>/queue               campaign, chunks, chunkEvents, leaseTimeout
+//   <dir>/todo/<c>            chunk c, not taken yet
+//   <dir>/leased/<c>@<owner>  chunk c, held by job <owner> = host.pid
+//   <dir>/done/<c>@<owner>    chunk c, written to the output of <owner>
+//
+// Chunk c is generated with the streams of job c of the campaign (see
+// SeedPartition.cc), so it is the same whichever job runs it. Every state
+// change is one rename(), which is atomic on local and NFS file systems:
+// of several jobs renaming the same file exactly one succeeds. A job renews
+// its leases by touching them. A lease not touched for leaseTimeout seconds
+// belongs to a dead job and is taken over by the next job asking for work.
+
+struct EventQueue {
+  std::string      dir;
+  std::string      owner;         // host.pid of this job
+  int              campaign;
+  int              nChunks;
+  int              chunkEvents;   // events per chunk
+  int              leaseTimeout;  // seconds
+  std::vector<int> held;          // chunks leased by this job, in order
+  time_t           lastRenew;
+};
+
+bool OpenEventQueue(const char *dir, EventQueue &queue);
+bool LeaseChunk(EventQueue &queue, int &chunk);
+// false if a lease was taken over by another job: the output of this job
+// then duplicates that chunk and must not be written
+bool RenewLeases(EventQueue &queue, bool force = false);
+bool CompleteLeases(EventQueue &queue);
+// Give the chunks of this job back to the queue, unwritten
+void ReleaseLeases(EventQueue &queue);
+
+#endif
@@ -0,0 +1,37 @@
+#include "Species.h"
+#include "TMath.h"
+#include "StageProfile.h"
+
+using namespace Pythia8;
+
+// Generator-level part of the candidate analysis, done once per matched
+// decay chain whatever the number of detector scenarios: the electron
+// histograms of the spec, conditions E0.5..E2.0 for the electron energy
+// thresholds 0.5..2 GeV, filled with the event weight.
+
+void FillTrueCandidate(const Event &event, const SpeciesTable &table, int iSpecies,
+		       const std::vector<int> &iNode, double weight, const HistList &electron)
+{
+  const int idElectron     =  11;
+
+  const DecayPattern &pattern = table.species[iSpecies].pattern;
+
+  for (size_t l = 0; l < pattern.leaf.size(); ++l) {
+    const Particle &leg = event[iNode[pattern.leaf[l]]];
+    if (leg.id() == idElectron && !electron.hist.empty()) {
+      PROFILE_STAGE(kStageFill);
+      double var[kNVars];
+      var[kVarPt]  = leg.pT();
+      var[kVarY]   = leg.y();
+      var[kVarPhi] = PhiPositive(leg.phi());
+      var[kVarEta] = leg.eta();
+      var[kVarE]   = leg.e();
+      unsigned int conds = kCondAll;
+      for (int k = 0; k < 4; ++k)
+	if (leg.e() >= 0.5*(k + 1)) conds |= 1 << (1 + k);
+      FillHistList(electron, conds, var, 1., weight);
+    }
+  }
+
+  return;
+}
@@ -0,0 +1,500 @@
+#include "HepMCInput.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef GZIPSUPPORT
+#include <zlib.h>
+#endif
+
+using namespace Pythia8;
+
+// Particle of the converted record, indices in Pythia conventions
+
+struct ExternalParticle {
+  int    id, status, mother1, mother2, daughter1, daughter2;
+  double px, py, pz, e, m;
+  double xProd, yProd, zProd, tProd;  // [mm]
+};
+
+struct ExternalEvent {
+  std::vector<ExternalParticle> particle;
+  double weight;
+  double sigma, sigmaErr;  // [mb]
+};
+
+// Particle and vertex as read from the file
+
+struct RawParticle {
+  int    id, status;
+  double px, py, pz, e, m;
+  int    prodVertex, endVertex;  // index in HepMCInput::vertex, -1 if none
+};
+
+struct RawVertex {
+  std::vector<int> in;  // incoming particles, index in HepMCInput::raw
+  int order;            // rank of first use as a production vertex
+  int first, last;      // outgoing particles in the converted record
+  int position;         // 0 none, 1 being resolved, 2 in pos
+  double pos[4];        // x y z t as read
+};
+
+struct HepMCInput {
+  // line source: memory-mapped file or zlib stream
+  const char *map;
+  size_t      mapSize, mapPos;
+#ifdef GZIPSUPPORT
+  gzFile      gz;
+#endif
+  std::string line;
+  bool        havePending;  // line holds the E line of the next event
+
+  // parser state, reused from event to event
+  std::vector<RawParticle> raw;
+  std::vector<RawVertex>   vertex;
+  std::map<int,int>        vertexIndex;  // HepMC vertex id -> index in vertex
+  std::vector<int>         key, order, newIndex;
+  double                   unitScale;    // to GeV
+  double                   lengthScale;  // to mm
+  double                   eventPos[4];  // of the E line, as read
+  double                   weight;       // of the event being parsed
+  double                   sigma, sigmaErr;
+
+  // bounded queue from the reader thread to the analysis
+  pthread_t                  thread;
+  pthread_mutex_t            mutex;
+  pthread_cond_t             notEmpty, notFull;
+  std::vector<ExternalEvent> ring;
+  size_t                     head, count;
+  bool                       done, stop;
+  bool                       started;  // reader thread running
+
+  // analysis side
+  ExternalEvent current;
+  double        lastSigma, lastSigmaErr;
+};
+
+static bool ReadLine(HepMCInput *in)
+{
+  in->line.clear();
+#ifdef GZIPSUPPORT
+  if (in->gz) {
+    char buf[4096];
+    while (gzgets(in->gz, buf, sizeof(buf))) {
+      in->line += buf;
+      if (in->line[in->line.size()-1] == '\n') break;
+    }
+  } else
+#endif
+  {
+    if (in->mapPos >= in->mapSize) return false;
+    const char *begin = in->map + in->mapPos;
+    const char *end = (const char*)memchr(begin, '\n', in->mapSize - in->mapPos);
+    if (!end) end = in->map + in->mapSize;
+    in->line.assign(begin, end - begin);
+    in->mapPos = end - in->map + 1;
+    return true;
+  }
+  if (in->line.empty()) return false;
+  while (!in->line.empty() && (in->line[in->line.size()-1] == '\n' || in->line[in->line.size()-1] == '\r'))
+    in->line.erase(in->line.size()-1);
+  return true;
+}
+
+static int VertexFor(HepMCInput *in, int id)
+{
+  std::map<int,int>::iterator iv = in->vertexIndex.find(id);
+  if (iv != in->vertexIndex.end()) return iv->second;
+  RawVertex v;
+  v.order    = -1;
+  v.position = 0;
+  in->vertex.push_back(v);
+  in->vertexIndex[id] = in->vertex.size() - 1;
+  return in->vertex.size() - 1;
+}
+
+// "V <id> <status> [<in1>,<in2>,...] @ x y z t", a single incoming
+// particle may be written without brackets
+
+static void ParseVertex(HepMCInput *in, const char *s)
+{
+  char *c;
+  int id = strtol(s + 1, &c, 10);
+  strtol(c, &c, 10);  // status
+  int iv = VertexFor(in, id);
+  while (*c == ' ') c++;
+  bool list = (*c == '[');
+  if (list) c++;
+  while (*c && *c != ']' && *c != '@') {
+    char *next;
+    int ip = strtol(c, &next, 10);
+    if (next == c) break;
+    if (ip >= 1 && ip <= (int)in->raw.size()) {
+      in->vertex[iv].in.push_back(ip - 1);
+      in->raw[ip-1].endVertex = iv;
+    }
+    c = next;
+    if (*c == ',') c++;
+    if (!list) break;
+  }
+  const char *at = strchr(c, '@');
+  if (at && sscanf(at + 1, "%lf %lf %lf %lf", &in->vertex[iv].pos[0], &in->vertex[iv].pos[1],
+		   &in->vertex[iv].pos[2], &in->vertex[iv].pos[3]) == 4)
+    in->vertex[iv].position = 2;
+}
+
+// Position of vertex iv, inherited from the production vertex of its first
+// incoming particle if it has none
+
+static const double *VertexPosition(HepMCInput *in, int iv)
+{
+  RawVertex &v = in->vertex[iv];
+  if (v.position == 2) return v.pos;
+  if (v.position == 1) return in->eventPos;  // a loop in a corrupt file
+  const double *pos = in->eventPos;
+  v.position = 1;
+  if (!v.in.empty() && in->raw[v.in[0]].prodVertex >= 0)
+    pos = VertexPosition(in, in->raw[v.in[0]].prodVertex);
+  for (int k = 0; k < 4; ++k) v.pos[k] = pos[k];
+  v.position = 2;
+  return v.pos;
+}
+
+// "P <id> <parent> <pdg> <px> <py> <pz> <e> <m> <status>", parent is the
+// production vertex (< 0) or the single incoming particle (> 0)
+
+static void ParseParticle(HepMCInput *in, const char *s)
+{
+  char *c;
+  RawParticle p;
+  strtol(s + 1, &c, 10);  // id, particles are numbered in file order
+  int parent = strtol(c, &c, 10);
+  p.id       = strtol(c, &c, 10);
+  p.px       = strtod(c, &c) * in->unitScale;
+  p.py       = strtod(c, &c) * in->unitScale;
+  p.pz       = strtod(c, &c) * in->unitScale;
+  p.e        = strtod(c, &c) * in->unitScale;
+  p.m        = strtod(c, &c) * in->unitScale;
+  p.status   = strtol(c, &c, 10);
+  p.endVertex = -1;
+  p.prodVertex = -1;
+  if (parent < 0) {
+    p.prodVertex = VertexFor(in, parent);
+  } else if (parent > 0 && parent <= (int)in->raw.size()) {
+    if (in->raw[parent-1].endVertex < 0) {
+      // implicit vertex, keyed by the positive id of its incoming particle
+      int iv = VertexFor(in, parent);
+      in->vertex[iv].in.push_back(parent - 1);
+      in->raw[parent-1].endVertex = iv;
+    }
+    p.prodVertex = in->raw[parent-1].endVertex;
+  }
+  in->raw.push_back(p);
+}
+
+struct ByKey {
+  const std::vector<int> *key;
+  bool operator()(int a, int b) const { return (*key)[a] < (*key)[b]; }
+};
+
+// Reorder the particles so that the outgoing particles of every vertex are
+// contiguous, beam particles first, vertices in order of first use
+
+static void ConvertEvent(HepMCInput *in, ExternalEvent &ev)
+{
+  int n = in->raw.size();
+  int nextOrder = 0;
+  in->key.resize(n);
+  in->order.resize(n);
+  in->newIndex.resize(n);
+  for (int i = 0; i < n; ++i) {
+    int pv = in->raw[i].prodVertex;
+    if (pv >= 0 && in->vertex[pv].order < 0) in->vertex[pv].order = nextOrder++;
+    in->key[i]   = pv >= 0 ? in->vertex[pv].order : -1;
+    in->order[i] = i;
+  }
+  ByKey byKey;
+  byKey.key = &in->key;
+  std::stable_sort(in->order.begin(), in->order.end(), byKey);
+
+  for (size_t iv = 0; iv < in->vertex.size(); ++iv) {
+    in->vertex[iv].first = 0;
+    in->vertex[iv].last  = 0;
+  }
+  for (int j = 0; j < n; ++j) {
+    in->newIndex[in->order[j]] = j + 1;  // entry 0 is the system
+    int pv = in->raw[in->order[j]].prodVertex;
+    if (pv < 0) continue;
+    if (in->vertex[pv].first == 0) in->vertex[pv].first = j + 1;
+    in->vertex[pv].last = j + 1;
+  }
+
+  ev.particle.resize(n);
+  for (int j = 0; j < n; ++j) {
+    const RawParticle &r = in->raw[in->order[j]];
+    ExternalParticle &p = ev.particle[j];
+    p.id        = r.id;
+    p.status    = r.status == 1 ? 1 : -abs(r.status);
+    p.mother1   = p.mother2   = 0;
+    p.daughter1 = p.daughter2 = 0;
+    if (r.prodVertex >= 0) {
+      const std::vector<int> &inc = in->vertex[r.prodVertex].in;
+      for (size_t k = 0; k < inc.size(); ++k) {
+	int im = in->newIndex[inc[k]];
+	if (p.mother1 == 0 || im < p.mother1) p.mother1 = im;
+	if (inc.size() > 1 && im > p.mother2) p.mother2 = im;
+      }
+    }
+    if (r.endVertex >= 0) {
+      p.daughter1 = in->vertex[r.endVertex].first;
+      p.daughter2 = in->vertex[r.endVertex].last;
+    }
+    p.px = r.px;
+    p.py = r.py;
+    p.pz = r.pz;
+    p.e  = r.e;
+    p.m  = r.m;
+    const double *pos = r.prodVertex >= 0 ? VertexPosition(in, r.prodVertex) : in->eventPos;
+    p.xProd = pos[0] * in->lengthScale;
+    p.yProd = pos[1] * in->lengthScale;
+    p.zProd = pos[2] * in->lengthScale;
+    p.tProd = pos[3] * in->lengthScale;
+  }
+  ev.weight   = in->weight;
+  ev.sigma    = in->sigma;
+  ev.sigmaErr = in->sigmaErr;
+}
+
+static bool ParseEvent(HepMCInput *in, ExternalEvent &ev)
+{
+  // skip to the next "E <number> <nVertices> <nParticles>" line
+  while (!in->havePending) {
+    if (!ReadLine(in)) return false;
+    if (in->line.compare(0, 2, "E ") == 0) break;
+  }
+  in->havePending = false;
+  in->raw.clear();
+  in->vertex.clear();
+  in->vertexIndex.clear();
+  in->weight = 1.;
+  // "E <number> <nVertices> <nParticles> [@ x y z t]"
+  const char *at = strchr(in->line.c_str(), '@');
+  if (!at || sscanf(at + 1, "%lf %lf %lf %lf", &in->eventPos[0], &in->eventPos[1],
+		    &in->eventPos[2], &in->eventPos[3]) != 4)
+    in->eventPos[0] = in->eventPos[1] = in->eventPos[2] = in->eventPos[3] = 0.;
+
+  while (ReadLine(in)) {
+    const char *s = in->line.c_str();
+    if (in->line.compare(0, 2, "E ") == 0) {
+      in->havePending = true;
+      break;
+    }
+    if (in->line.size() < 2 || s[1] != ' ') continue;  // HepMC:: listing markers, empty lines
+    switch (s[0]) {
+    case 'P': ParseParticle(in, s); break;
+    case 'V': ParseVertex(in, s); break;
+    case 'U':
+      // "U GEV|MEV MM|CM", positions are scaled at the end of the event
+      in->unitScale   = strstr(s, "MEV") ? 1.e-3 : 1.;
+      in->lengthScale = strstr(s, " CM") ? 10. : 1.;
+      break;
+    case 'W': in->weight = strtod(s + 1, NULL); break;  // the first is the nominal weight
+    case 'A': {
+      // "A 0 GenCrossSection <sigma> <error> ..." in pb
+      int id;
+      char name[64];
+      double sigma, sigmaErr;
+      if (sscanf(s, "A %d %63s %lf %lf", &id, name, &sigma, &sigmaErr) == 4 &&
+	  !strcmp(name, "GenCrossSection")) {
+	in->sigma    = sigma * 1.e-9;
+	in->sigmaErr = sigmaErr * 1.e-9;
+      }
+      break;
+    }
+    default: break;
+    }
+  }
+
+  ConvertEvent(in, ev);
+  return true;
+}
+
+static void *ReaderThread(void *arg)
+{
+  HepMCInput *in = (HepMCInput*)arg;
+  ExternalEvent ev;
+  while (ParseEvent(in, ev)) {
+    pthread_mutex_lock(&in->mutex);
+    while (in->count == in->ring.size() && !in->stop)
+      pthread_cond_wait(&in->notFull, &in->mutex);
+    if (in->stop) {
+      pthread_mutex_unlock(&in->mutex);
+      break;
+    }
+    ExternalEvent &slot = in->ring[(in->head + in->count) % in->ring.size()];
+    slot.particle.swap(ev.particle);
+    slot.weight   = ev.weight;
+    slot.sigma    = ev.sigma;
+    slot.sigmaErr = ev.sigmaErr;
+    in->count++;
+    pthread_cond_signal(&in->notEmpty);
+    pthread_mutex_unlock(&in->mutex);
+  }
+  pthread_mutex_lock(&in->mutex);
+  in->done = true;
+  pthread_cond_broadcast(&in->notEmpty);
+  pthread_mutex_unlock(&in->mutex);
+  return NULL;
+}
+
+HepMCInput *OpenHepMCInput(const char *fileName, int queueDepth)
+{
+  HepMCInput *in = new HepMCInput;
+  in->map         = NULL;
+  in->mapSize     = 0;
+  in->mapPos      = 0;
+#ifdef GZIPSUPPORT
+  in->gz          = NULL;
+#endif
+  in->havePending = false;
+  in->started     = false;
+  in->unitScale   = 1.;
+  in->lengthScale = 1.;
+  in->sigma       = in->sigmaErr     = 0.;
+  in->lastSigma   = in->lastSigmaErr = 0.;
+
+  size_t len = strlen(fileName);
+  if (len > 3 && !strcmp(fileName + len - 3, ".gz")) {
+#ifdef GZIPSUPPORT
+    in->gz = gzopen(fileName, "rb");
+    if (!in->gz) {
+      printf("Error: cannot open %s\n", fileName);
+      delete in;
+      return NULL;
+    }
+    gzbuffer(in->gz, 1 << 20);
+#else
+    printf("Error: %s is compressed, rebuild with ENABLEGZIP=yes\n", fileName);
+    delete in;
+    return NULL;
+#endif
+  } else {
+    int fd = open(fileName, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+      printf("Error: cannot open %s\n", fileName);
+      if (fd >= 0) close(fd);
+      delete in;
+      return NULL;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      printf("Error: cannot map %s\n", fileName);
+      delete in;
+      return NULL;
+    }
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    in->map     = (const char*)map;
+    in->mapSize = st.st_size;
+  }
+
+  if (!ReadLine(in) || (in->line.compare(0, 16, "HepMC::Version 3") != 0 &&
+			in->line.compare(0, 14, "HepMC::Asciiv3") != 0)) {
+    printf("Error: %s is not a HepMC3 ASCII file\n", fileName);
+    CloseHepMCInput(in);
+    return NULL;
+  }
+
+  in->ring.resize(queueDepth > 0 ? queueDepth : 1);
+  in->head = in->count = 0;
+  in->done = in->stop  = false;
+  pthread_mutex_init(&in->mutex, NULL);
+  pthread_cond_init(&in->notEmpty, NULL);
+  pthread_cond_init(&in->notFull, NULL);
+  if (pthread_create(&in->thread, NULL, ReaderThread, in) != 0) {
+    printf("Error: cannot start the reader thread\n");
+    CloseHepMCInput(in);
+    return NULL;
+  }
+  in->started = true;
+  printf("Reading HepMC3 events from %s\n", fileName);
+  return in;
+}
+
+bool ReadHepMCEvent(HepMCInput *in, Event &event, double &weight)
+{
+  pthread_mutex_lock(&in->mutex);
+  while (in->count == 0 && !in->done)
+    pthread_cond_wait(&in->notEmpty, &in->mutex);
+  if (in->count == 0) {
+    pthread_mutex_unlock(&in->mutex);
+    return false;
+  }
+  ExternalEvent &slot = in->ring[in->head];
+  in->current.particle.swap(slot.particle);
+  in->current.weight   = slot.weight;
+  in->current.sigma    = slot.sigma;
+  in->current.sigmaErr = slot.sigmaErr;
+  in->head = (in->head + 1) % in->ring.size();
+  in->count--;
+  pthread_cond_signal(&in->notFull);
+  pthread_mutex_unlock(&in->mutex);
+
+  const std::vector<ExternalParticle> &particle = in->current.particle;
+  double px = 0., py = 0., pz = 0., e = 0.;
+  for (size_t i = 0; i < particle.size(); ++i) {
+    if (particle[i].status != 1) continue;
+    px += particle[i].px;
+    py += particle[i].py;
+    pz += particle[i].pz;
+    e  += particle[i].e;
+  }
+  double m2 = e*e - px*px - py*py - pz*pz;
+
+  event.reset();
+  event.append(90, -11, 0, 0, 1, particle.size(), 0, 0, px, py, pz, e, m2 > 0. ? sqrt(m2) : 0.);
+  for (size_t i = 0; i < particle.size(); ++i) {
+    const ExternalParticle &p = particle[i];
+    int ie = event.append(p.id, p.status, p.mother1, p.mother2, p.daughter1, p.daughter2, 0, 0,
+			  p.px, p.py, p.pz, p.e, p.m);
+    event[ie].vProd(p.xProd, p.yProd, p.zProd, p.tProd);
+  }
+  in->lastSigma    = in->current.sigma;
+  in->lastSigmaErr = in->current.sigmaErr;
+  weight = in->current.weight;
+  return true;
+}
+
+void HepMCCrossSection(const HepMCInput *in, double &sigma, double &sigmaErr)
+{
+  sigma    = in->lastSigma;
+  sigmaErr = in->lastSigmaErr;
+}
+
+void CloseHepMCInput(HepMCInput *in)
+{
+  if (in->started) {
+    pthread_mutex_lock(&in->mutex);
+    in->stop = true;
+    pthread_cond_broadcast(&in->notFull);
+    pthread_mutex_unlock(&in->mutex);
+    pthread_join(in->thread, NULL);
+    pthread_mutex_destroy(&in->mutex);
+    pthread_cond_destroy(&in->notEmpty);
+    pthread_cond_destroy(&in->notFull);
+  }
+  if (in->map) munmap((void*)in->map, in->mapSize);
+#ifdef GZIPSUPPORT
+  if (in->gz) gzclose(in->gz);
+#endif
+  delete in;
+}
@@ -0,0 +1,29 @@
+#ifndef HEPMCINPUT_H
+#define HEPMCINPUT_H
+
+#include "Pythia8/Pythia.h"
+
+// Streaming input of HepMC3 ASCII files (Asciiv3), e.g. samples generated
+// elsewhere with other tunes. A reader thread parses the file, mapped into
+// memory or, for .gz files, through zlib (ENABLEGZIP=yes), and hands the
+// events to the analysis through a bounded queue, so parsing overlaps the
+// analysis of the previous events.
+//
+// Events are converted to the Pythia event record: entry 0 is the system,
+// the outgoing particles of every vertex are stored contiguously, so that
+// daughter1..daughter2 span the decay products, and mother1/mother2 are the
+// incoming particles of the production vertex. Final particles (HepMC
+// status 1) get status 1, all others minus their HepMC status. The event
+// weight is the first value of the W line, 1 if there is none. Particles
+// get the position of their production vertex [mm]: its own "@ x y z t",
+// else that of its first incoming particle, else that of the event (E line).
+
+struct HepMCInput;
+
+HepMCInput *OpenHepMCInput(const char *fileName, int queueDepth = 64);
+bool ReadHepMCEvent(HepMCInput *input, Pythia8::Event &event, double &weight);
+// cross section and its error [mb] of the last GenCrossSection read, 0 if none
+void HepMCCrossSection(const HepMCInput *input, double &sigma, double &sigmaErr);
+void CloseHepMCInput(HepMCInput *input);
+
+#endif
@@ -0,0 +1,140 @@
+#include "Species.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace Pythia8;
+
+// Name and latex title of a final leg in the histogram names
+
+static void LegName(int id, char *name, char *title)
+{
+  switch (id) {
+  case   22: sprintf(name, "Gamma");    sprintf(title, "#gamma");    break;
+  case   11: sprintf(name, "Electron"); sprintf(title, "e^{-}");     break;
+  case  -11: sprintf(name, "Positron"); sprintf(title, "e^{+}");     break;
+  case   13: sprintf(name, "MuMinus");  sprintf(title, "#mu^{-}");   break;
+  case  -13: sprintf(name, "MuPlus");   sprintf(title, "#mu^{+}");   break;
+  case  211: sprintf(name, "PiPlus");   sprintf(title, "#pi^{+}");   break;
+  case -211: sprintf(name, "PiMinus");  sprintf(title, "#pi^{-}");   break;
+  default:   sprintf(name, "Id%d", id); sprintf(title, "id %d", id); break;
+  }
+}
+
+// Placeholders of the histogram spec, see HistSpec.h
+
+static void AddSubst(std::vector<std::string> &subst, const char *key, const std::string &value)
+{
+  subst.push_back(key);
+  subst.push_back(value);
+}
+
+void BookHistSet(const HistSpec &spec, const SpeciesTable &table, HistSet &hists, const char *suffix)
+{
+  char legName[64], legTitle[64];
+
+  hists.species.resize(table.species.size());
+  for (size_t is = 0; is < table.species.size(); ++is) {
+    const Species &sp = table.species[is];
+    SpeciesHists &h = hists.species[is];
+
+    std::vector<std::string> subst;
+    AddSubst(subst, "{species}", sp.name);
+    AddSubst(subst, "{title}",   sp.title);
+    BookHistList(spec, kSiteMother,    subst, suffix, h.mother);
+    BookHistList(spec, kSiteCandidate, subst, suffix, h.candidate);
+
+    h.leg.resize(sp.pattern.leaf.size());
+    for (size_t l = 0; l < sp.pattern.leaf.size(); ++l) {
+      int id = sp.pattern.node[sp.pattern.leaf[l]].id;
+      LegName(id, legName, legTitle);
+      // number repeated legs of the same kind
+      int nSame = 0;
+      for (size_t m = 0; m < l; ++m)
+	if (sp.pattern.node[sp.pattern.leaf[m]].id == id) nSame++;
+      if (nSame > 0) sprintf(legName + strlen(legName), "%d", nSame+1);
+      std::vector<std::string> legSubst;
+      AddSubst(legSubst, "{leg}",   legName);
+      AddSubst(legSubst, "{title}", legTitle);
+      AddSubst(legSubst, "{tag}",   sp.legTag);
+      BookHistList(spec, kSiteLeg, legSubst, suffix, h.leg[l]);
+    }
+  }
+
+  hists.mass.resize(table.massGroup.size());
+  for (size_t ig = 0; ig < table.massGroup.size(); ++ig) {
+    const MassGroup &g = table.massGroup[ig];
+    std::vector<std::string> subst;
+    AddSubst(subst, "{resTitle}", g.resTitle);
+    AddSubst(subst, "{allTitle}", g.allTitle);
+    AddSubst(subst, "{res}",      g.resName);
+    AddSubst(subst, "{all}",      g.allName);
+    HistAxisSpec autoAxis[kNVars];
+    HistAxisSpec res  = {kVarMRes, false, g.nResBins,  g.resMin,  g.resMax};
+    HistAxisSpec all  = {kVarMAll, false, g.nAllBins,  g.allMin,  g.allMax};
+    HistAxisSpec diff = {kVarDM,   false, g.nDiffBins, g.diffMin, g.diffMax};
+    autoAxis[kVarMRes] = res;
+    autoAxis[kVarMAll] = all;
+    autoAxis[kVarDM]   = diff;
+    BookHistList(spec, kSiteMass, subst, suffix, hists.mass[ig], autoAxis);
+  }
+
+  return;
+}
+
+void BookGlobalHists(const HistSpec &spec, GlobalHists &hists)
+{
+  std::vector<std::string> subst;
+  BookHistList(spec, kSiteElectron, subst, "", hists.electron);
+  BookHistList(spec, kSitePi0,      subst, "", hists.pi0);
+}
+
+// Convert the xsec spectra to differential cross sections. The mass
+// spectra of the default spec stay in units of weighted counts.
+
+void ScaleHistSet(HistSet &hists, double sigmaWeight, double dy)
+{
+  for (size_t is = 0; is < hists.species.size(); ++is) {
+    SpeciesHists &h = hists.species[is];
+    ScaleHistList(h.mother,    sigmaWeight, dy);
+    ScaleHistList(h.candidate, sigmaWeight, dy);
+    for (size_t l = 0; l < h.leg.size(); ++l) ScaleHistList(h.leg[l], sigmaWeight, dy);
+  }
+  for (size_t ig = 0; ig < hists.mass.size(); ++ig) ScaleHistList(hists.mass[ig], sigmaWeight, dy);
+
+  return;
+}
+
+// Add the histograms of other, booked for the same species table and spec
+
+void AddHistSet(HistSet &hists, const HistSet &other)
+{
+  for (size_t is = 0; is < hists.species.size(); ++is) {
+    SpeciesHists &h = hists.species[is];
+    const SpeciesHists &o = other.species[is];
+    AddHistList(h.mother,    o.mother);
+    AddHistList(h.candidate, o.candidate);
+    for (size_t l = 0; l < h.leg.size(); ++l) AddHistList(h.leg[l], o.leg[l]);
+  }
+  for (size_t ig = 0; ig < hists.mass.size(); ++ig) AddHistList(hists.mass[ig], other.mass[ig]);
+
+  return;
+}
+
+void WriteHistSet(HistSet &hists, std::string &norms)
+{
+  for (size_t is = 0; is < hists.species.size(); ++is) {
+    SpeciesHists &h = hists.species[is];
+    WriteHistList(h.mother, norms);
+    WriteHistList(h.candidate, norms);
+    for (size_t l = 0; l < h.leg.size(); ++l) WriteHistList(h.leg[l], norms);
+  }
+  for (size_t ig = 0; ig < hists.mass.size(); ++ig) WriteHistList(hists.mass[ig], norms);
+
+  return;
+}
+
+void WriteGlobalHists(GlobalHists &hists, std::string &norms)
+{
+  WriteHistList(hists.electron, norms);
+  WriteHistList(hists.pi0, norms);
+}
@@ -0,0 +1,266 @@
+#include "HistSpec.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "TMath.h"
+
+// The standard output of pythia_chic2.exe
+
+static const char *defaultSpec =
+  "# Default histogram spec of pythia_chic2.exe, see HistSpec.h\n"
+  "#\n"
+  "# on|off site condition name \"title\" x-axis [y-axis] weight norm\n"
+  "\n"
+  "on  mother    all     h{species}_pt_all      \"All {title} p_{T} spectrum\" pt:250:0:50   1  xsec\n"
+  "on  candidate cndtn_1 h{species}_pt_cndtn_1  \"{title} p_{T} spectrum\"     pt:250:0:50   br xsec\n"
+  "on  candidate cndtn_2 h{species}_pt_cndtn_2  \"{title} p_{T} spectrum\"     pt:250:0:50   br xsec\n"
+  "on  candidate cndtn_3 h{species}_pt_cndtn_3  \"{title} p_{T} spectrum\"     pt:250:0:50   br xsec\n"
+  "on  candidate cndtn_1 h{species}_y_cndtn_1   \"{title} y spectrum\"         y:250:0:0.5   br xsec\n"
+  "on  candidate cndtn_2 h{species}_y_cndtn_2   \"{title} y spectrum\"         y:250:0:0.5   br xsec\n"
+  "on  candidate cndtn_3 h{species}_y_cndtn_3   \"{title} y spectrum\"         y:250:0:0.5   br xsec\n"
+  "off candidate cndtn_3 h{species}_phi_cndtn_3 \"{title} #varphi spectrum\"   phi:360:0:2pi br xsec\n"
+  "on  leg       all     h{leg}{tag}_pt_all     \"{title} p_{T} spectrum\"     pt:250:0:50   br xsec\n"
+  "\n"
+  "on  mass all     {res}                     \"{resTitle}\" mRes:auto ptRes:50:0:50 br counts\n"
+  "on  mass all     {all}                     \"{allTitle}\" mAll:auto ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_1 {all}_cndtn_1             \"{allTitle}\" mAll:auto ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_2 {all}_cndtn_2             \"{allTitle}\" mAll:auto ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_3 {all}_cndtn_3             \"{allTitle}\" mAll:auto ptAll:50:0:50 br counts\n"
+  "on  mass all     {all}_mass_diff           \"{allTitle}\" dM:auto   ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_1 {all}_mass_diff_cndtn_1   \"{allTitle}\" dM:auto   ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_2 {all}_mass_diff_cndtn_2   \"{allTitle}\" dM:auto   ptAll:50:0:50 br counts\n"
+  "on  mass cndtn_3 {all}_mass_diff_cndtn_3   \"{allTitle}\" dM:auto   ptAll:50:0:50 br counts\n"
+  "on  mass pcm     {all}_pcm                 \"{allTitle}\" mAll:auto ptAll:50:0:50 br counts\n"
+  "on  mass pcm     {all}_mass_diff_pcm       \"{allTitle}\" dM:auto   ptAll:50:0:50 br counts\n"
+  "\n"
+  "off electron all  hChiC_electrons_phi_rapid          \"all #chi_{cJ} #phi, y\" phi:360:0:2pi y:100:-0.7:0.7 1 counts\n"
+  "on  electron E0.5 hChiC_electrons_phi_rapid_p0_0dot5 \"all #chi_{cJ} #phi, y\" phi:360:0:2pi y:100:-0.7:0.7 1 counts\n"
+  "on  electron E1.0 hChiC_electrons_phi_rapid_p0_1dot0 \"all #chi_{cJ} #phi, y\" phi:360:0:2pi y:100:-0.7:0.7 1 counts\n"
+  "on  electron E1.5 hChiC_electrons_phi_rapid_p0_1dot5 \"all #chi_{cJ} #phi, y\" phi:360:0:2pi y:100:-0.7:0.7 1 counts\n"
+  "on  electron E2.0 hChiC_electrons_phi_rapid_p0_2dot0 \"all #chi_{cJ} #phi, y\" phi:360:0:2pi y:100:-0.7:0.7 1 counts\n"
+  "on  pi0      all  hMass2Gamma \"M(#gamma#gamma) vs p_{T}\" m:150:0:0.3 pt:50:0:50 1 counts\n";
+
+static const char *siteName[kNSites] = {"mother", "candidate", "leg", "mass", "electron", "pi0"};
+static const char *varName[kNVars] = {"pt", "y", "phi", "eta", "e",
+				      "mAll", "mRes", "dM", "ptAll", "ptRes", "m"};
+
+// variables of every site, bit per HistVar
+static const unsigned int siteVars[kNSites] = {
+  1 << kVarPt | 1 << kVarY | 1 << kVarPhi,
+  1 << kVarPt | 1 << kVarY | 1 << kVarPhi,
+  1 << kVarPt | 1 << kVarY | 1 << kVarPhi | 1 << kVarEta | 1 << kVarE,
+  1 << kVarMAll | 1 << kVarMRes | 1 << kVarDM | 1 << kVarPtAll | 1 << kVarPtRes,
+  1 << kVarPt | 1 << kVarY | 1 << kVarPhi | 1 << kVarEta | 1 << kVarE,
+  1 << kVarM | 1 << kVarPt,
+};
+
+// conditions of every site, by bit index
+static const int kMaxCond = 5;
+static const char *siteCond[kNSites][kMaxCond] = {
+  {"all"},
+  {"all", "cndtn_1", "cndtn_2", "cndtn_3", "pcm"},
+  {"all"},
+  {"all", "cndtn_1", "cndtn_2", "cndtn_3", "pcm"},
+  {"all", "E0.5", "E1.0", "E1.5", "E2.0"},
+  {"all"},
+};
+
+const char *DefaultHistSpec()
+{
+  return defaultSpec;
+}
+
+static int FindName(const char *name, const char *const *list, int n)
+{
+  for (int i = 0; i < n; ++i)
+    if (list[i] && !strcmp(list[i], name)) return i;
+  return -1;
+}
+
+static bool ParseLimit(const char *text, double &value)
+{
+  if (!strcmp(text, "2pi")) {
+    value = TMath::TwoPi();
+    return true;
+  }
+  char *end;
+  value = strtod(text, &end);
+  return end != text && *end == '\0';
+}
+
+// <variable>:<bins>:<min>:<max> or <variable>:auto
+static bool ParseAxis(const std::string &text, int site, HistAxisSpec &axis)
+{
+  std::vector<std::string> field;
+  for (size_t pos = 0; ; ) {
+    size_t colon = text.find(':', pos);
+    field.push_back(text.substr(pos, colon == std::string::npos ? colon : colon - pos));
+    if (colon == std::string::npos) break;
+    pos = colon + 1;
+  }
+  axis.var = FindName(field[0].c_str(), varName, kNVars);
+  if (axis.var < 0 || !(siteVars[site] >> axis.var & 1)) return false;
+  axis.autoBins = field.size() == 2 && field[1] == "auto";
+  // only the masses have a binning of the mass group
+  if (axis.autoBins)
+    return site == kSiteMass && (axis.var == kVarMRes || axis.var == kVarMAll || axis.var == kVarDM);
+  axis.nBins = field.size() == 4 ? atoi(field[1].c_str()) : 0;
+  return axis.nBins > 0 && ParseLimit(field[2].c_str(), axis.min) &&
+    ParseLimit(field[3].c_str(), axis.max) && axis.min < axis.max;
+}
+
+// Split a line into words; "..." is one word, '#' starts a comment
+static bool SplitLine(const char *line, std::vector<std::string> &word)
+{
+  const char *c = line;
+  for (;;) {
+    while (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r') c++;
+    if (*c == '\0' || *c == '#') return true;
+    if (*c == '"') {
+      const char *end = strchr(c + 1, '"');
+      if (!end) return false;
+      word.push_back(std::string(c + 1, end));
+      c = end + 1;
+    } else {
+      const char *start = c;
+      while (*c && *c != ' ' && *c != '\t' && *c != '\n' && *c != '\r') c++;
+      word.push_back(std::string(start, c));
+    }
+  }
+}
+
+static bool ParseEntry(const std::vector<std::string> &word, HistSpecEntry &e)
+{
+  if (word.size() != 8 && word.size() != 9) return false;
+  if (word[0] != "on" && word[0] != "off") return false;
+  e.enabled = word[0] == "on";
+  e.site = FindName(word[1].c_str(), siteName, kNSites);
+  if (e.site < 0) return false;
+  e.cond = FindName(word[2].c_str(), siteCond[e.site], kMaxCond);
+  if (e.cond < 0) return false;
+  e.name  = word[3];
+  e.title = word[4];
+  if (!ParseAxis(word[5], e.site, e.x)) return false;
+  e.y.var = -1;
+  if (word.size() == 9 && !ParseAxis(word[6], e.site, e.y)) return false;
+  const std::string &weight = word[word.size() - 2];
+  const std::string &norm   = word[word.size() - 1];
+  if (weight != "1" && weight != "br") return false;
+  e.weightBr = weight == "br";
+  if (norm != "counts" && norm != "xsec") return false;
+  e.norm = norm == "xsec" ? kNormXsec : kNormCounts;
+  return true;
+}
+
+bool ReadHistSpec(const char *fileName, HistSpec &spec)
+{
+  spec.entry.clear();
+  spec.text.clear();
+  spec.source = fileName ? fileName : "default";
+  if (fileName) {
+    FILE *f = fopen(fileName, "r");
+    if (!f) {
+      printf("Error: cannot read histogram spec %s\n", fileName);
+      return false;
+    }
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) spec.text.append(buffer, n);
+    fclose(f);
+  } else {
+    spec.text = defaultSpec;
+  }
+
+  int iLine = 0, nEnabled = 0;
+  for (size_t pos = 0; pos < spec.text.size(); ) {
+    size_t end = spec.text.find('\n', pos);
+    if (end == std::string::npos) end = spec.text.size();
+    std::string line = spec.text.substr(pos, end - pos);
+    pos = end + 1;
+    iLine++;
+    std::vector<std::string> word;
+    HistSpecEntry e;
+    bool split = SplitLine(line.c_str(), word);
+    if (split && word.empty()) continue;
+    if (!split || !ParseEntry(word, e)) {
+      printf("Error: %s, line %d: not a histogram entry, see HistSpec.h\n", spec.source.c_str(), iLine);
+      return false;
+    }
+    spec.entry.push_back(e);
+    if (e.enabled) nEnabled++;
+  }
+  printf("Histogram spec %s: %d entries, %d enabled\n", spec.source.c_str(),
+	 (int)spec.entry.size(), nEnabled);
+  return true;
+}
+
+static std::string Substitute(std::string text, const std::vector<std::string> &subst)
+{
+  for (size_t i = 0; i + 1 < subst.size(); i += 2) {
+    size_t pos;
+    while ((pos = text.find(subst[i])) != std::string::npos)
+      text.replace(pos, subst[i].size(), subst[i+1]);
+  }
+  return text;
+}
+
+void BookHistList(const HistSpec &spec, int site, const std::vector<std::string> &subst,
+		  const char *suffix, HistList &list, const HistAxisSpec *autoAxis)
+{
+  list.hist.clear();
+  list.vars  = 0;
+  list.conds = 0;
+  for (size_t ie = 0; ie < spec.entry.size(); ++ie) {
+    const HistSpecEntry &e = spec.entry[ie];
+    if (!e.enabled || e.site != site) continue;
+    std::string name  = Substitute(e.name, subst) + suffix;
+    std::string title = Substitute(e.title, subst);
+    HistAxisSpec x = e.x.autoBins ? autoAxis[e.x.var] : e.x;
+    HistAxisSpec y = e.y.var >= 0 && e.y.autoBins ? autoAxis[e.y.var] : e.y;
+
+    SpecHist s;
+    s.cond     = e.cond;
+    s.xVar     = e.x.var;
+    s.yVar     = e.y.var;
+    s.weightBr = e.weightBr;
+    s.norm     = e.norm;
+    if (e.y.var >= 0) {
+      s.h2 = new TH2F(name.c_str(), title.c_str(), x.nBins, x.min, x.max, y.nBins, y.min, y.max);
+      s.h  = s.h2;
+    } else {
+      s.h2 = NULL;
+      s.h  = new TH1F(name.c_str(), title.c_str(), x.nBins, x.min, x.max);
+    }
+    s.h->Sumw2();
+    list.hist.push_back(s);
+    list.vars  |= 1 << s.xVar;
+    if (s.yVar >= 0) list.vars |= 1 << s.yVar;
+    list.conds |= 1 << s.cond;
+  }
+}
+
+// xsec: cross section per unit x and per unit rapidity in the window dy
+
+void ScaleHistList(HistList &list, double sigmaWeight, double dy)
+{
+  for (size_t i = 0; i < list.hist.size(); ++i) {
+    if (list.hist[i].norm != kNormXsec) continue;
+    TH1 *h = list.hist[i].h;
+    double binWidth = (h->GetXaxis()->GetXmax() - h->GetXaxis()->GetXmin())/h->GetNbinsX();
+    h->Scale(sigmaWeight/(binWidth*dy));
+  }
+}
+
+void AddHistList(HistList &list, const HistList &other)
+{
+  for (size_t i = 0; i < list.hist.size(); ++i) list.hist[i].h->Add(other.hist[i].h);
+}
+
+void WriteHistList(const HistList &list, std::string &norms)
+{
+  for (size_t i = 0; i < list.hist.size(); ++i) {
+    list.hist[i].h->Write();
+    norms += std::string(list.hist[i].h->GetName()) +
+      (list.hist[i].norm == kNormXsec ? " xsec\n" : " counts\n");
+  }
+}
@@ -0,0 +1,153 @@
+#ifndef HISTSPEC_H
+#define HISTSPEC_H
+
+#include <string>
+#include <vector>
+#include "TH1.h"
+#include "TH2.h"
+#include "TMath.h"
+
+// Histogram spec: the histograms of a run, what they are filled with and
+// how they are normalised, one line per histogram,
+//
+//   on|off <site> <condition> <name> "<title>" <x axis> [<y axis>] <weight> <norm>
+//
+// '#' starts a comment. The built-in default (DefaultHistSpec()) books the
+// standard output; -hists <file> reads another spec, and the spec of a run
+// is saved in its output as "histSpec".
+//
+// site       where the histogram is filled, and once per what it is booked:
+//   mother     every quarkonium mother within the rapidity window, per species
+//   candidate  every matched candidate, per species
+//   leg        every final leg of a candidate, per species and leg
+//   mass       every candidate and pileup combination, per mass group
+//   electron   the generator-level electrons of a candidate, once per run
+//   pi0        every pi0 -> gamma gamma decay, once per run
+// condition  fill only if it holds: all, and at the candidate and mass sites
+//   cndtn_1, cndtn_2, cndtn_3 (see AnalyseCandidate.h) or pcm; at the
+//   electron site E0.5, E1.0, E1.5 or E2.0 for the electron energy in GeV
+// name, title  templates: {species} and {title} (latex) of the species, at
+//   the leg site {leg}, {title} of the leg and {tag} of the species; at the
+//   mass site {res}, {resTitle}, {all}, {allTitle} of the mass group.
+//   Histograms of the first four sites get the scenario suffix.
+// axis       <variable>:<bins>:<min>:<max>, min and max may be "2pi"; at the
+//   mass site mRes:auto, mAll:auto and dM:auto take the binning of the mass
+//   group.
+//   Variables: pt, y, phi (mother and candidate: of the mother; leg: of the
+//   measured leg, also eta and e; electron: true phi, y, e), mAll, mRes,
+//   dM = mAll - mRes, ptAll, ptRes (mass), m and pt (pi0: gamma gamma pair)
+// weight     1, or br for the decay-chain weight of the species; either
+//   times the event weight of weighted input (HepMC3)
+// norm       counts (weighted counts), or xsec for the cross section per
+//   unit x and unit rapidity: sigmaGen/nAccepted/(x bin width * 2 ymax)
+//
+// Only the enabled entries are booked, so disabled ones cost nothing in the
+// event loop. The norm of every histogram written is saved in the output as
+// "histNorm", lines "<name> counts|xsec", for tools such as Reweight.C.
+
+enum HistSite {
+  kSiteMother,
+  kSiteCandidate,
+  kSiteLeg,
+  kSiteMass,
+  kSiteElectron,
+  kSitePi0,
+  kNSites
+};
+
+enum HistVar {
+  kVarPt, kVarY, kVarPhi, kVarEta, kVarE,
+  kVarMAll, kVarMRes, kVarDM, kVarPtAll, kVarPtRes, kVarM,
+  kNVars
+};
+
+// Condition bits of a fill; at the electron site bit 1+k is the k-th
+// energy threshold
+enum HistCond {
+  kCondAll    = 1,
+  kCondCndtn1 = 2,
+  kCondCndtn2 = 4,
+  kCondCndtn3 = 8,
+  kCondPcm    = 16
+};
+
+enum HistNorm {
+  kNormCounts,
+  kNormXsec
+};
+
+struct HistAxisSpec {
+  int    var;    // HistVar, -1 for no axis
+  bool   autoBins;
+  int    nBins;
+  double min, max;
+};
+
+struct HistSpecEntry {
+  bool         enabled;
+  int          site;
+  int          cond;    // bit index
+  std::string  name, title;
+  HistAxisSpec x, y;
+  bool         weightBr;
+  int          norm;
+};
+
+struct HistSpec {
+  std::vector<HistSpecEntry> entry;
+  std::string text;    // as read
+  std::string source;  // file name, or "default"
+};
+
+// One booked histogram and how to fill it
+struct SpecHist {
+  TH1 *h;
+  TH2 *h2;  // h if 2D, else NULL
+  int  cond, xVar, yVar;
+  bool weightBr;
+  int  norm;
+};
+
+// The enabled histograms of one fill site, with the variables (bit per
+// HistVar) and conditions (HistCond bits) they use: a fill site computes
+// only those, and skips work that no histogram needs
+struct HistList {
+  std::vector<SpecHist> hist;
+  unsigned int vars;
+  unsigned int conds;
+};
+
+const char *DefaultHistSpec();
+// Read the spec of fileName, the built-in default if NULL
+bool ReadHistSpec(const char *fileName, HistSpec &spec);
+
+// Book the enabled entries of site; name and title placeholders from subst,
+// pairs of {key} and value; autoAxis[var] is the binning of <var>:auto
+void BookHistList(const HistSpec &spec, int site, const std::vector<std::string> &subst,
+		  const char *suffix, HistList &list, const HistAxisSpec *autoAxis = NULL);
+void ScaleHistList(HistList &list, double sigmaWeight, double dy);
+void AddHistList(HistList &list, const HistList &other);
+// Write the histograms of list and append their norms to norms
+void WriteHistList(const HistList &list, std::string &norms);
+
+// Azimuth in [0, 2pi), the range of the phi variables
+inline double PhiPositive(double phi)
+{
+  return phi < 0. ? phi + TMath::TwoPi() : phi;
+}
+
+// Fill every histogram of list whose condition is among conds, with the
+// event weight times br or 1
+inline void FillHistList(const HistList &list, unsigned int conds, const double *var, double br,
+			 double weight)
+{
+  for (size_t i = 0; i < list.hist.size(); ++i) {
+    const SpecHist &s = list.hist[i];
+    if (!(conds >> s.cond & 1)) continue;
+    double w = s.weightBr ? weight*br : weight;
+    if (s.h2) s.h2->Fill(var[s.xVar], var[s.yVar], w);
+    else      s.h ->Fill(var[s.xVar], w);
+  }
+}
+
+#endif
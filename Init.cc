@@ -1,14 +1,29 @@
 #include "Pythia8/Pythia.h"
-#include "TRandom.h"
+#include <string>
 using namespace Pythia8;
 
-void Init(Pythia* pythia)
+// Pass one setting to Pythia and record it for the run manifest
+
+static void ReadString(Pythia* pythia, const char* line, std::string &settings)
 {
+  pythia->readString(line);
+  settings += line;
+  settings += "\n";
+}
 
-  TRandom rndm;
+// Set up Pythia with the given random seed and collision energy eCM [GeV].
+// All settings are appended to settings, whose hash identifies runs that
+// may be merged.
+// With lhefFile the hard processes are read from a Les Houches event file
+// (.lhe or .lhe.gz) instead of generated; lhefDecayOnly switches off showers,
+// multiparton interactions and string fragmentation, so that Pythia only
+// decays the given particles. PartonLevel:all stays on: switched off, Pythia
+// stops after the hard process and the event record stays empty.
+
+void Init(Pythia* pythia, int pythiaSeed, double eCM, const char *lhefFile, bool lhefDecayOnly,
+	  std::string &settings)
+{
 
-  rndm.SetSeed(0);
-  int pythiaSeed = rndm.Integer(1000000);
   char processLine[80];
   sprintf(processLine, "Random:Seed = %d",pythiaSeed);
 
@@ -16,24 +31,41 @@ void Init(Pythia* pythia)
   pythia->readString(processLine); 
 
   //Set process type and collision energy
-  pythia->readString("Charmonium:all  = on");;
-  pythia->readString("Beams:eCM = 13000.");
+  if (lhefFile) {
+    // the file name goes to the manifest, so that files of one sample merge
+    std::string lhef = std::string("Beams:LHEF = ") + lhefFile;
+    ReadString(pythia, "Beams:frameType = 4", settings);
+    pythia->readString(lhef);
+    if (lhefDecayOnly) {
+      ReadString(pythia, "PartonLevel:ISR = off", settings);
+      ReadString(pythia, "PartonLevel:FSR = off", settings);
+      ReadString(pythia, "PartonLevel:MPI = off", settings);
+      ReadString(pythia, "HadronLevel:Hadronize = off", settings);
+    }
+  } else {
+    ReadString(pythia, "Charmonium:all  = on", settings);
+    char eCMLine[80];
+    // "13000." as before, so that the settings hash of old runs still agrees
+    if (eCM == (int)eCM) sprintf(eCMLine, "Beams:eCM = %d.", (int)eCM);
+    else                 sprintf(eCMLine, "Beams:eCM = %g", eCM);
+    ReadString(pythia, eCMLine, settings);
+  }
 
   // Switch off all J/psi decays but J/psi -> e+ e-
-  pythia->readString("443:onMode = off");
-  pythia->readString("443:onIfAny = 11 -11");
+  ReadString(pythia, "443:onMode = off", settings);
+  ReadString(pythia, "443:onIfAny = 11 -11", settings);
 
   // Switch off all chi_c2 decays but chi_c2 -> J/psi gamma
-  pythia->readString("445:onMode = off");
-  pythia->readString("445:onIfAny = 443 22");
+  ReadString(pythia, "445:onMode = off", settings);
+  ReadString(pythia, "445:onIfAny = 443 22", settings);
 
   // Switch off all chi_c2 decays but chi_c0 -> J/psi gamma
-  pythia->readString("10441:onMode = off");
-  pythia->readString("10441:onIfAny = 443 22");
+  ReadString(pythia, "10441:onMode = off", settings);
+  ReadString(pythia, "10441:onIfAny = 443 22", settings);
 
   // Switch off all chi_c2 decays but chi_c1 -> J/psi gamma
-  pythia->readString("20443:onMode = off");
-  pythia->readString("20443:onIfAny = 443 22");
+  ReadString(pythia, "20443:onMode = off", settings);
+  ReadString(pythia, "20443:onIfAny = 443 22", settings);
 
   //pythia.readString("PhaseSpace:pTHatMin = 7.");
 
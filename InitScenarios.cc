@@ -0,0 +1,62 @@
+#include "Scenario.h"
+#include "AnalyseCandidate.h"
+#include <cstdio>
+#include <cstring>
+
+// Registry of the known detector scenarios. A new scenario is a new
+// combination of policies from DetectorPolicy.h and one line here.
+
+struct ScenarioDef {
+  const char *name;
+  const char *suffix;
+  const char *description;
+  AnalyseFunc analyse;
+};
+
+static const ScenarioDef scenarioDef[] = {
+  {"realistic", "",         "PHOS at 460 cm, realistic resolutions",
+   &AnalyseCandidate<RealisticDetector>},
+  {"ideal",     "_ideal",   "ideal energy, momentum and position resolution, no material",
+   &AnalyseCandidate<Detector<IdealEnergyRes, IdealMomentumRes, IdealPosition, NoMaterial> >},
+  {"anghie",    "_anghie",  "ANGHIE CALO at 150 cm, realistic resolutions",
+   &AnalyseCandidate<Detector<PhosEnergyRes, TrackMomentumRes, AnghiePosition> >},
+  {"ppr",       "_ppr",     "PHOS at 460 cm, coordinate resolution of PPR vol.II",
+   &AnalyseCandidate<Detector<PhosEnergyRes, TrackMomentumRes, PprPosition> >},
+};
+static const int nScenarioDef = sizeof(scenarioDef)/sizeof(scenarioDef[0]);
+
+bool InitScenarios(const char *list, std::vector<Scenario> &scenarios)
+{
+  char buffer[1024];
+  strncpy(buffer, list, sizeof(buffer)-1);
+  buffer[sizeof(buffer)-1] = '\0';
+
+  for (char *name = strtok(buffer, ","); name; name = strtok(NULL, ",")) {
+    int id = 0;
+    while (id < nScenarioDef && strcmp(scenarioDef[id].name, name)) id++;
+    if (id == nScenarioDef) {
+      printf("Error: unknown detector scenario \"%s\"\n", name);
+      return false;
+    }
+    for (size_t is = 0; is < scenarios.size(); ++is) {
+      if (scenarios[is].name == name) {
+	printf("Error: detector scenario \"%s\" given twice\n", name);
+	return false;
+      }
+    }
+    Scenario scenario;
+    scenario.name    = scenarioDef[id].name;
+    scenario.suffix  = scenarioDef[id].suffix;
+    scenario.analyse = scenarioDef[id].analyse;
+    scenario.energy  = 0;
+    scenarios.push_back(scenario);
+  }
+
+  return !scenarios.empty();
+}
+
+void ListScenarios()
+{
+  for (int id = 0; id < nScenarioDef; ++id)
+    printf("         %-10s %s\n", scenarioDef[id].name, scenarioDef[id].description);
+}
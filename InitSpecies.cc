@@ -0,0 +1,65 @@
+#include "Species.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Pythia8;
+
+// Register one species: compile its decay pattern and add it to the
+// id -> species dispatch table used by the event scan
+
+static void AddSpecies(SpeciesTable &table, const char *name, const char *title,
+		       const char *legTag, int id, int status, double br,
+		       int massGroup, const char *pattern)
+{
+  Species species;
+  species.name      = name;
+  species.title     = title;
+  species.legTag    = legTag;
+  species.status    = status;
+  species.br        = br;
+  species.massGroup = massGroup;
+  if (!CompileDecayPattern(pattern, id, species.pattern)) {
+    printf("Error: cannot compile decay pattern \"%s\" of %s\n", pattern, name);
+    exit(1);
+  }
+  if (species.pattern.leaf.size() > (size_t)kMaxLeg) {
+    printf("Error: decay pattern of %s has more than %d final legs\n", name, kMaxLeg);
+    exit(1);
+  }
+  if (table.dispatch.count(id)) {
+    printf("Error: species %s has the same mother id %d as another species\n", name, id);
+    exit(1);
+  }
+  table.dispatch[id] = table.species.size();
+  table.species.push_back(species);
+}
+
+void InitSpecies(SpeciesTable &table)
+{
+  // chi_cJ -> J/psi gamma, J/psi -> e+ e-
+  MassGroup chic = {"hMassElecPosi",    "M(e^{+}e^{-}) vs p_{T}",        200, 2.6, 3.6,
+		    "hMassGamElecPosi", "M(#gamma e^{+}e^{-}) vs p_{T}", 200, 3.0, 4.0,
+		    160, 0., 0.8};
+  table.massGroup.push_back(chic);
+
+  AddSpecies(table, "ChiC2", "#chi_{c2}", "",       445,   -62, 114.624e-04, 0, "X -> (443 -> 11 -11) 22");
+  AddSpecies(table, "ChiC0", "#chi_{c0}", "_chic0", 10441, -62, 7.5819e-04,  0, "X -> (443 -> 11 -11) 22");
+  AddSpecies(table, "ChiC1", "#chi_{c1}", "_chic1", 20443, -62, 202.383e-04, 0, "X -> (443 -> 11 -11) 22");
+
+  // Further states only need a pattern, a mass group and their decays
+  // switched on in Init(), e.g.
+  // MassGroup chib = {"hMassElecPosi_chib",    "M(e^{+}e^{-}) vs p_{T}",        200,  9.0, 10.0,
+  // 		    "hMassGamElecPosi_chib", "M(#gamma e^{+}e^{-}) vs p_{T}", 200,  9.5, 10.5,
+  // 		    160, 0., 0.8};
+  // table.massGroup.push_back(chib);
+  // AddSpecies(table, "ChiB1", "#chi_{b1}", "_chib1", 20553, -62, 0.35*0.0238,
+  // 	     table.massGroup.size() - 1, "X -> (553 -> 11 -11) 22");
+  // MassGroup psi2s = {"hMassElecPosi_psi2s", "M(e^{+}e^{-}) vs p_{T}",              200, 2.6, 3.6,
+  // 		     "hMassPiPiElecPosi",   "M(#pi^{+}#pi^{-}e^{+}e^{-}) vs p_{T}", 200, 3.2, 4.2,
+  // 		     160, 0.4, 0.8};
+  // table.massGroup.push_back(psi2s);
+  // AddSpecies(table, "Psi2S", "#psi(2S)", "_psi2s", 100443, -62, 0.347*0.0597,
+  // 	     table.massGroup.size() - 1, "X -> (443 -> 11 -11) 211 -211");
+
+  return;
+}
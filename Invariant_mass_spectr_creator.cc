@@ -1,60 +1,27 @@
 #include "TLorentzVector.h"
 #include "TH1.h"
 #include "TH2.h"
+#include "Species.h"
+#include "StageProfile.h"
 
-bool IsElectronDetectedInCTS(TLorentzVector);
-bool IsPhotonDetectedInEMCAL(TLorentzVector);
-bool IsPhotonDetectedInPHOS(TLorentzVector); 
+// Fill the invariant-mass spectra of one candidate. p_res is the summed
+// 4-momentum of the resonance daughters (e+e- from J/psi), p_all the sum of
+// all final legs (gamma e+e-); conds are the HistCond bits that hold, e.g.
+// no kCondAll for pileup combinations, which the unconditioned spectra
+// would count twice. weight is the event weight.
 
-void Invariant_mass_spectr_creator(TLorentzVector p_el, TLorentzVector p_pos, TLorentzVector p_gam,
-				  TH2F *hMassElecPosi,
-				  TH2F *hMassGamElecPosi,
-				  TH2F *hMassGamElecPosi_cndtn_1,
-				  TH2F *hMassGamElecPosi_cndtn_2,
-				  TH2F *hMassGamElecPosi_cndtn_3,
-				  TH2F *hMassGamElecPosi_mass_diff,
-				  TH2F *hMassGamElecPosi_mass_diff_cndtn_1,
-				  TH2F *hMassGamElecPosi_mass_diff_cndtn_2,
-				  TH2F *hMassGamElecPosi_mass_diff_cndtn_3, double br)
+void Invariant_mass_spectr_creator(TLorentzVector p_res, TLorentzVector p_all,
+				   unsigned int conds, const HistList &mass, double br, double weight)
 {
-  
-  hMassGamElecPosi->Fill((p_el + p_pos + p_gam).M(), (p_el + p_pos + p_gam).Pt(), br);
-  hMassElecPosi->Fill((p_el + p_pos).M(), (p_el + p_pos).Pt(), br);
-  hMassGamElecPosi_mass_diff->Fill((p_el + p_pos + p_gam).M() - (p_el + p_pos).M(), 
-				   (p_el + p_pos + p_gam).Pt(), br);
-  
-  if (IsElectronDetectedInCTS(p_el)  &&
-      IsElectronDetectedInCTS(p_pos) &&
-      IsPhotonDetectedInPHOS(p_gam))
-    {
-      
-      hMassGamElecPosi_cndtn_1->Fill((p_el + p_pos + p_gam).M(), (p_el + p_pos + p_gam).Pt(), br);
-      hMassGamElecPosi_mass_diff_cndtn_1->Fill((p_el + p_pos + p_gam).M() - (p_el + p_pos).M(),
-					       (p_el + p_pos + p_gam).Pt(), br);
-    }
-  
-  if (IsElectronDetectedInCTS(p_el)   &&
-      IsElectronDetectedInCTS(p_pos) &&
-      IsPhotonDetectedInPHOS(p_gam)   &&
-      p_gam.E() > 5.0)
-    {
-      
-      hMassGamElecPosi_cndtn_2->Fill((p_el + p_pos + p_gam).M(), (p_el + p_pos + p_gam).Pt(), br);
-      hMassGamElecPosi_mass_diff_cndtn_2->Fill((p_el + p_pos + p_gam).M() - (p_el + p_pos).M(), 
-					       (p_el + p_pos + p_gam).Pt(), br);
-    }
-
-  if (IsPhotonDetectedInEMCAL(p_el)  &&
-      IsPhotonDetectedInEMCAL(p_pos) &&
-      IsPhotonDetectedInPHOS(p_gam)  &&
-      p_gam.E() > 2.0)
-    {
-      
-      hMassGamElecPosi_cndtn_3->Fill((p_el + p_pos + p_gam).M(), (p_el + p_pos + p_gam).Pt(), br);
-      hMassGamElecPosi_mass_diff_cndtn_3->Fill((p_el + p_pos + p_gam).M() - (p_el + p_pos).M(), 
-					       (p_el + p_pos + p_gam).Pt(), br);
-    }
-  
+  if (mass.hist.empty()) return;
+  PROFILE_STAGE(kStageMass);
+  double var[kNVars];
+  var[kVarMAll]  = p_all.M();
+  var[kVarMRes]  = p_res.M();
+  var[kVarDM]    = var[kVarMAll] - var[kVarMRes];
+  var[kVarPtAll] = p_all.Pt();
+  var[kVarPtRes] = p_res.Pt();
+  FillHistList(mass, conds, var, br, weight);
   
   return;
 }
@@ -1,7 +1,9 @@
 #include "TLorentzVector.h"
+#include "StageProfile.h"
 
-bool IsElectronDetectedInCTS(TLorentzVector p){
+bool IsElectronDetectedInCTS(TLorentzVector p, double pTmin){
 
+  PROFILE_STAGE(kStageAcceptance);
   bool flag = false;
 
   double px = p.Px();
@@ -12,7 +14,7 @@ bool IsElectronDetectedInCTS(TLorentzVector p){
   double eta = 0.5*log((p.P() + pz)/(p.P() - pz));
 
   if (fabs(eta) < 0.8 && 
-      pT >= 1.0 ){
+      pT >= pTmin ){
     flag = true;
   }
 
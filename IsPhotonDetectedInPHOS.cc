@@ -1,35 +1,14 @@
-#include "TMath.h"
 #include "TLorentzVector.h"
+#include "CaloGeometry.h"
+#include "StageProfile.h"
 
-bool IsPhotonDetectedInPHOS(TLorentzVector p)
+bool IsPhotonDetectedInPHOS(TLorentzVector p, double eMin, double zVertex)
 {
-  // Check if a particle with 4-momentum p hits the PHOS acceptance
-  // |y|<0.12, 250<phi<320 degrees
+  // Check if a particle with 4-momentum p from the vertex at z = zVertex [cm]
+  // hits a live PHOS cell (CaloGeometry.h), with energy above eMin
   
-  bool flag = false;
+  PROFILE_STAGE(kStageAcceptance);
+  if (p.E() <= eMin) return false;
 
-  double px = p.Px();
-  double py = p.Py();
-  double pz = p.Pz();
-  double p0 = p.E();
-
-  double y;
-  if (p0>pz)
-    y = 0.5*log((p0 + pz)/(p0 - pz));
-  else
-    y=100;
-
-  double phi;
-  phi = TMath::ATan2(py,px); // azimuth angle in range (-pi,+pi)
-  if (phi < 0) phi += TMath::TwoPi();  // azimuth angle in range (0,+2pi)
-  phi *= TMath::RadToDeg();
-
-  if (fabs(y) < 0.12 &&
-      phi > 250.     && 
-      phi < 320.     &&
-      p0 > 1.0       ){
-    flag = true;
-  }  
-  
-  return flag;
+  return IsCellLive(kPHOS, CaloCell(kPHOS, p, zVertex));
 }
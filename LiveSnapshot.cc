@@ -0,0 +1,241 @@
+#include "LiveSnapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "TH2.h"
+
+static double WallTime()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1.e-6*tv.tv_usec;
+}
+
+static LiveHistEntry *Entries(const LiveHeader *header)
+{
+  return (LiveHistEntry*)((char*)header + sizeof(LiveHeader));
+}
+
+static LiveBuffer *Buffer(const LiveHeader *header, int b)
+{
+  return (LiveBuffer*)((char*)header + header->bufferOffset[b]);
+}
+
+static double *Values(LiveBuffer *buffer)
+{
+  return (double*)((char*)buffer + sizeof(LiveBuffer));
+}
+
+bool OpenLiveSnapshot(const char *fileName, const std::vector<TH1*> &hists, ULong64_t settingsHash,
+		      double every, LiveSnapshot &live)
+{
+  // per histogram: contents, Sumw2 and the number of entries
+  ULong64_t nValues = 0;
+  std::vector<LiveHistEntry> entry(hists.size());
+  for (size_t ih = 0; ih < hists.size(); ++ih) {
+    TH1 *h = hists[ih];
+    LiveHistEntry &e = entry[ih];
+    memset(&e, 0, sizeof(e));
+    strncpy(e.name,  h->GetName(),  sizeof(e.name) - 1);
+    strncpy(e.title, h->GetTitle(), sizeof(e.title) - 1);
+    e.dim    = h->GetDimension();
+    e.nBinsX = h->GetNbinsX();
+    e.nBinsY = h->GetNbinsY();
+    e.xMin   = h->GetXaxis()->GetXmin();
+    e.xMax   = h->GetXaxis()->GetXmax();
+    e.yMin   = h->GetYaxis()->GetXmin();
+    e.yMax   = h->GetYaxis()->GetXmax();
+    e.offset = nValues;
+    e.nCells = h->GetNcells();
+    if (e.dim > 2 || strlen(h->GetName()) >= sizeof(e.name)) {
+      printf("Error: histogram %s cannot be published live\n", h->GetName());
+      return false;
+    }
+    nValues += 2*e.nCells + 1;
+  }
+
+  // buffers on cache-line boundaries
+  size_t headerSize = sizeof(LiveHeader) + entry.size()*sizeof(LiveHistEntry);
+  headerSize = (headerSize + 63) & ~(size_t)63;
+  size_t bufferSize = sizeof(LiveBuffer) + nValues*sizeof(double);
+  bufferSize = (bufferSize + 63) & ~(size_t)63;
+  live.mapSize = headerSize + 2*bufferSize;
+
+  // a new file, so that viewers still mapping an old one are not truncated
+  unlink(fileName);
+  int fd = open(fileName, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0 || ftruncate(fd, live.mapSize) != 0) {
+    printf("Error: cannot create live snapshot file %s\n", fileName);
+    if (fd >= 0) close(fd);
+    return false;
+  }
+  void *map = mmap(NULL, live.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    printf("Error: cannot map live snapshot file %s\n", fileName);
+    return false;
+  }
+  live.map    = (char*)map;
+  live.header = (LiveHeader*)map;
+  live.hist   = hists;
+  live.every  = every;
+  live.last   = WallTime();
+
+  LiveHeader *header = live.header;
+  header->nHists          = hists.size();
+  header->pid             = getpid();
+  header->nValues         = nValues;
+  header->bufferOffset[0] = headerSize;
+  header->bufferOffset[1] = headerSize + bufferSize;
+  header->settingsHash    = settingsHash;
+  header->startTime       = live.last;
+  if (!entry.empty()) memcpy(Entries(header), &entry[0], entry.size()*sizeof(LiveHistEntry));
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(header->magic, "CHICLV1", 8);
+
+  printf("Live snapshots of %d histograms (%.1f MB) every %g s in %s\n",
+	 (int)hists.size(), 2.*bufferSize/1048576., every, fileName);
+  return true;
+}
+
+void PublishLiveSnapshot(LiveSnapshot &live, const LiveStatus &status)
+{
+  LiveHeader *header = live.header;
+  // the buffer that is not published
+  ULong64_t published = header->published;
+  LiveBuffer *buffer = Buffer(header, published % 2);
+  ULong64_t version = buffer->version;
+  __atomic_store_n(&buffer->version, version + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  buffer->status      = status;
+  buffer->status.time = WallTime();
+  double *value = Values(buffer);
+  const LiveHistEntry *entry = Entries(header);
+  for (size_t ih = 0; ih < live.hist.size(); ++ih) {
+    TH1 *h = live.hist[ih];
+    double *v = value + entry[ih].offset;
+    const ULong64_t nCells = entry[ih].nCells;
+    const TArrayD *sumw2 = h->GetSumw2N() ? h->GetSumw2() : NULL;
+    for (ULong64_t i = 0; i < nCells; ++i) {
+      v[i] = h->GetBinContent(i);
+      v[nCells + i] = sumw2 ? sumw2->At(i) : v[i];
+    }
+    v[2*nCells] = h->GetEntries();
+  }
+
+  __atomic_store_n(&buffer->version, version + 2, __ATOMIC_RELEASE);
+  __atomic_store_n(&header->published, published + 1, __ATOMIC_RELEASE);
+  live.last = buffer->status.time;
+}
+
+void UpdateLiveSnapshot(LiveSnapshot &live, const LiveStatus &status)
+{
+  if (WallTime() - live.last < live.every) return;
+  PublishLiveSnapshot(live, status);
+}
+
+void CloseLiveSnapshot(LiveSnapshot &live, const LiveStatus &status)
+{
+  PublishLiveSnapshot(live, status);
+  __atomic_store_n(&live.header->finished, 1, __ATOMIC_RELEASE);
+  munmap(live.map, live.mapSize);
+  live.map    = NULL;
+  live.header = NULL;
+}
+
+bool ReadLiveSnapshot(const char *fileName, LiveHeader &header, LiveStatus &status,
+		      std::vector<TH1*> &hists)
+{
+  int fd = open(fileName, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(LiveHeader)) {
+    printf("Error: cannot read live snapshot file %s\n", fileName);
+    if (fd >= 0) close(fd);
+    return false;
+  }
+  size_t mapSize = st.st_size;
+  void *map = mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    printf("Error: cannot map live snapshot file %s\n", fileName);
+    return false;
+  }
+  const LiveHeader *h = (const LiveHeader*)map;
+  if (memcmp(h->magic, "CHICLV1", 8) != 0) {
+    printf("Error: %s is not a live snapshot file, or not yet initialised\n", fileName);
+    munmap(map, mapSize);
+    return false;
+  }
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  header = *h;
+  size_t bufferSize = sizeof(LiveBuffer) + header.nValues*sizeof(double);
+  if (sizeof(LiveHeader) + header.nHists*sizeof(LiveHistEntry) > header.bufferOffset[0] ||
+      header.bufferOffset[1] < header.bufferOffset[0] + bufferSize ||
+      header.bufferOffset[1] + bufferSize > mapSize) {
+    printf("Error: live snapshot file %s is truncated\n", fileName);
+    munmap(map, mapSize);
+    return false;
+  }
+
+  // copy the last published buffer until it is not overwritten meanwhile
+  std::vector<double> value(header.nValues);
+  bool consistent = false;
+  for (int attempt = 0; attempt < 1000 && !consistent; ++attempt) {
+    ULong64_t published = __atomic_load_n(&h->published, __ATOMIC_ACQUIRE);
+    if (published == 0) break;
+    LiveBuffer *buffer = Buffer(h, (published - 1) % 2);
+    ULong64_t version = __atomic_load_n(&buffer->version, __ATOMIC_ACQUIRE);
+    if (version % 2 == 0) {
+      status = buffer->status;
+      if (!value.empty()) memcpy(&value[0], Values(buffer), value.size()*sizeof(double));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      consistent = __atomic_load_n(&buffer->version, __ATOMIC_RELAXED) == version;
+    }
+    if (!consistent) usleep(1000);
+  }
+  header.published = h->published;
+  header.finished  = h->finished;
+
+  if (consistent) {
+    const LiveHistEntry *entry = Entries(h);
+    for (UInt_t ih = 0; ih < header.nHists; ++ih) {
+      const LiveHistEntry &e = entry[ih];
+      if (e.offset + 2*e.nCells + 1 > header.nValues) {
+	printf("Error: live snapshot file %s is corrupt\n", fileName);
+	consistent = false;
+	break;
+      }
+      TH1 *hist;
+      if (e.dim == 2)
+	hist = new TH2D(e.name, e.title, e.nBinsX, e.xMin, e.xMax, e.nBinsY, e.yMin, e.yMax);
+      else
+	hist = new TH1D(e.name, e.title, e.nBinsX, e.xMin, e.xMax);
+      hist->SetDirectory(0);
+      hist->Sumw2();
+      if ((ULong64_t)hist->GetNcells() != e.nCells) {
+	printf("Error: live snapshot file %s is corrupt\n", fileName);
+	delete hist;
+	consistent = false;
+	break;
+      }
+      const double *v = &value[e.offset];
+      TArrayD *sumw2 = hist->GetSumw2();
+      for (ULong64_t i = 0; i < e.nCells; ++i) {
+	hist->SetBinContent(i, v[i]);
+	(*sumw2)[i] = v[e.nCells + i];
+      }
+      hist->SetEntries(v[2*e.nCells]);
+      hists.push_back(hist);
+    }
+  } else {
+    printf("Error: no consistent snapshot in %s%s\n", fileName,
+	   header.published ? "" : ", none published yet");
+  }
+  munmap(map, mapSize);
+  return consistent;
+}
@@ -0,0 +1,85 @@
+#ifndef LIVESNAPSHOT_H
+#define LIVESNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TH1.h"
+
+// Live snapshots of the histograms of a running job (pythia_chic2.exe -live),
+// read by liveView.exe while the job runs. The job maps the snapshot file
+// shared and every few seconds copies the raw bin contents and Sumw2 of its
+// histograms into it, without any lock: there are two buffers, each with a
+// version that is odd while the buffer is written. The job always writes
+// the buffer that is not published and then publishes it, so it never
+// waits for a reader. A reader copies the last published buffer and retries
+// if its version changed meanwhile, i.e. if the job has since published
+// the next snapshot and overwritten this one.
+//
+// Only the histograms booked before the event loop are published (not the
+// per-subprocess sets of -subprocesses), as weighted counts before the
+// cross-section normalisation.
+//
+// File layout: LiveHeader, LiveHistEntry entry[nHists], then the two
+// buffers, each a LiveBuffer followed by double value[nValues]. Histogram
+// i has its contents at value[entry[i].offset] and its Sumw2 right after.
+
+struct LiveStatus {
+  ULong64_t nEvents;    // events generated
+  ULong64_t nAccepted;  // Pythia's accepted events, of all energies
+  double    sigmaGen;   // mb, 0 for several energies
+  double    time;       // of the snapshot, seconds since the epoch
+};
+
+struct LiveHeader {
+  char      magic[8];   // "CHICLV1", written last
+  UInt_t    nHists;
+  UInt_t    pid;
+  ULong64_t nValues;    // per buffer
+  ULong64_t bufferOffset[2];
+  ULong64_t settingsHash;
+  ULong64_t published;  // snapshots published, the last in buffer (published-1)%2
+  UInt_t    finished;   // the job has ended
+  UInt_t    reserved;
+  double    startTime;  // seconds since the epoch
+};
+
+struct LiveHistEntry {
+  char      name[96];
+  char      title[96];
+  UInt_t    dim, nBinsX, nBinsY, reserved;
+  double    xMin, xMax, yMin, yMax;
+  ULong64_t offset;     // in value[], nCells contents then nCells Sumw2
+  ULong64_t nCells;     // bins including under- and overflow
+};
+
+struct LiveBuffer {
+  ULong64_t  version;   // odd while being written
+  LiveStatus status;
+};
+
+struct LiveSnapshot {
+  char             *map;
+  size_t            mapSize;
+  LiveHeader       *header;
+  std::vector<TH1*> hist;
+  double            every;  // seconds between snapshots
+  double            last;   // time of the last snapshot
+};
+
+// Job side: create the snapshot file for the histograms hists
+bool OpenLiveSnapshot(const char *fileName, const std::vector<TH1*> &hists, ULong64_t settingsHash,
+		      double every, LiveSnapshot &live);
+// Publish a snapshot if the last one is older than live.every seconds; the
+// time of status is set on publishing
+void UpdateLiveSnapshot(LiveSnapshot &live, const LiveStatus &status);
+void PublishLiveSnapshot(LiveSnapshot &live, const LiveStatus &status);
+// Publish the final snapshot and mark the job finished
+void CloseLiveSnapshot(LiveSnapshot &live, const LiveStatus &status);
+
+// Viewer side: consistent copy of the last snapshot of a snapshot file as
+// new histograms (TH1D, TH2D), not attached to any directory
+bool ReadLiveSnapshot(const char *fileName, LiveHeader &header, LiveStatus &status,
+		      std::vector<TH1*> &hists);
+
+#endif
@@ -0,0 +1,42 @@
+#include "TFile.h"
+#include "TObjString.h"
+#include <cstdio>
+#include <string>
+
+// Hash of the run settings (FNV-1a, 64 bit). Two outputs may only be
+// merged if their settings hashes agree.
+
+ULong64_t SettingsHash(const std::string &settings)
+{
+  ULong64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < settings.size(); ++i) {
+    hash ^= (unsigned char)settings[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Write the run manifest as "key = value" lines next to the output file
+// (<name>.manifest) and into the output file itself as "manifest".
+
+void WriteManifest(const char *rootFileName, TFile *outFile, const std::string &manifest)
+{
+  std::string fileName = rootFileName;
+  size_t dot = fileName.rfind(".root");
+  if (dot != std::string::npos) fileName.erase(dot);
+  fileName += ".manifest";
+
+  FILE *f = fopen(fileName.c_str(), "w");
+  if (f) {
+    fputs(manifest.c_str(), f);
+    fclose(f);
+  } else {
+    printf("Error: cannot write manifest %s\n", fileName.c_str());
+  }
+
+  outFile->cd();
+  TObjString text(manifest.c_str());
+  text.Write("manifest");
+
+  return;
+}
@@ -0,0 +1,95 @@
+#include "PileupPool.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "TMath.h"
+
+bool OpenPileupPool(const char *fileName, PileupPool &pool)
+{
+  pool.map     = NULL;
+  pool.mapSize = 0;
+
+  int fd = open(fileName, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    printf("Error: cannot open pileup pool %s\n", fileName);
+    if (fd >= 0) close(fd);
+    return false;
+  }
+  if ((size_t)st.st_size < sizeof(PileupPoolHeader)) {
+    printf("Error: %s is not a pileup pool\n", fileName);
+    close(fd);
+    return false;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    printf("Error: cannot map pileup pool %s\n", fileName);
+    return false;
+  }
+  // pool events are picked at random, read-ahead would be wasted
+  madvise(map, st.st_size, MADV_RANDOM);
+  pool.map     = (const char*)map;
+  pool.mapSize = st.st_size;
+  pool.header  = (const PileupPoolHeader*)pool.map;
+  pool.offset  = (const ULong64_t*)(pool.map + sizeof(PileupPoolHeader));
+  pool.photon  = (const PileupPhoton*)(pool.offset + pool.header->nEvents + 1);
+
+  // a truncated or foreign file would be read out of bounds later
+  const PileupPoolHeader &h = *pool.header;
+  size_t size = sizeof(PileupPoolHeader) + ((size_t)h.nEvents + 1)*sizeof(ULong64_t);
+  if (memcmp(h.magic, "CHICPU1", 8) != 0 || h.nEvents == 0 ||
+      (size_t)st.st_size < size ||
+      (size_t)st.st_size != size + pool.offset[h.nEvents]*sizeof(PileupPhoton) ||
+      pool.offset[h.nEvents] != h.nPhotons) {
+    printf("Error: %s is not a pileup pool or is truncated\n", fileName);
+    ClosePileupPool(pool);
+    return false;
+  }
+  printf("Pileup pool %s: %u minimum-bias events at %g GeV, %llu photons within |eta| < %g\n",
+	 fileName, h.nEvents, h.eCM, h.nPhotons, h.etaMax);
+  return true;
+}
+
+void ClosePileupPool(PileupPool &pool)
+{
+  if (pool.map) munmap((void*)pool.map, pool.mapSize);
+  pool.map     = NULL;
+  pool.mapSize = 0;
+}
+
+// The draws depend only on the event key, so the pileup of an event is the
+// same in every detector scenario and for every job that repeats the event.
+
+void OverlayPileup(const PileupPool &pool, double mu, const RandomKey &eventKey,
+		   PileupEvent &pileup)
+{
+  RandomKey key = eventKey;
+  key.particle = kPileupParticle;
+  RandomStream rndm(key, kRndmPileup);
+
+  // Poisson(mu) by multiplication of uniforms, fine for the mu of a collider
+  int n = 0;
+  double limit = TMath::Exp(-mu);
+  for (double prod = rndm.Rndm(); prod > limit; prod *= rndm.Rndm()) n++;
+
+  pileup.nCollisions = n;
+  pileup.photon.clear();
+  const UInt_t nEvents = pool.header->nEvents;
+  for (int ic = 0; ic < n; ++ic) {
+    UInt_t iEvent = (UInt_t)(rndm.Rndm() * nEvents);
+    if (iEvent >= nEvents) iEvent = nEvents - 1;
+    double phi = TMath::TwoPi() * rndm.Rndm();
+    double c = TMath::Cos(phi), s = TMath::Sin(phi);
+    for (ULong64_t ip = pool.offset[iEvent]; ip < pool.offset[iEvent+1]; ++ip) {
+      const PileupPhoton &g = pool.photon[ip];
+      double px = c*g.px - s*g.py;
+      double py = s*g.px + c*g.py;
+      double e  = TMath::Sqrt(px*px + py*py + (double)g.pz*g.pz);
+      pileup.photon.push_back(TLorentzVector(px, py, g.pz, e));
+    }
+  }
+}
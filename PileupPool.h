@@ -0,0 +1,60 @@
+#ifndef PILEUPPOOL_H
+#define PILEUPPOOL_H
+
+#include <vector>
+#include "Rtypes.h"
+#include "TLorentzVector.h"
+#include "CounterRandom.h"
+
+// Pileup overlay from a pool of pre-generated minimum-bias events, written
+// by mkPileupPool.exe. The pool file is mapped into memory read-only, so all
+// jobs of a node share one copy in the page cache. Every signal event gets
+// Poisson(mu) pool events, each rotated by a random azimuthal angle so that
+// reused pool events do not repeat the same detector response.
+//
+// The pool keeps the final-state photons within |eta| < etaMax, i.e. what
+// the calorimeters see. Charged pileup tracks come from other vertices and
+// are rejected by the vertex association of the tracking; they are not kept.
+//
+// File layout: PileupPoolHeader, ULong64_t offset[nEvents+1] (first photon
+// of every event), PileupPhoton photon[nPhotons].
+
+struct PileupPoolHeader {
+  char      magic[8];  // "CHICPU1"
+  UInt_t    nEvents;
+  UInt_t    reserved;
+  ULong64_t nPhotons;
+  double    eCM;       // GeV
+  double    etaMax;
+};
+
+struct PileupPhoton {
+  float px, py, pz;  // GeV, massless
+};
+
+struct PileupPool {
+  const char             *map;
+  size_t                  mapSize;
+  const PileupPoolHeader *header;
+  const ULong64_t        *offset;
+  const PileupPhoton     *photon;
+};
+
+// Pileup of one signal event
+struct PileupEvent {
+  int nCollisions;
+  std::vector<TLorentzVector> photon;
+};
+
+// Base of the particle index of pileup draws in RandomKey: the pool draws of
+// an event use kPileupParticle, the smearing of pileup photon i uses
+// kPileupParticle + 1 + i. Signal event records never get that long.
+const UInt_t kPileupParticle = 0x80000000;
+
+bool OpenPileupPool(const char *fileName, PileupPool &pool);
+void ClosePileupPool(PileupPool &pool);
+// Overlay Poisson(mu) pool events for the signal event of eventKey
+void OverlayPileup(const PileupPool &pool, double mu, const RandomKey &eventKey,
+		   PileupEvent &pileup);
+
+#endif
@@ -0,0 +1,60 @@
+#include "PrecisionTarget.h"
+#include "TH2.h"
+#include "TROOT.h"
+#include <cstdio>
+#include <cstring>
+
+bool ParsePrecisionTarget(const char *text, PrecisionTarget &target)
+{
+  char name[256];
+  if (strlen(text) >= sizeof(name) ||
+      sscanf(text, "%255[^:]:%lf:%lf:%lf", name, &target.ptMin, &target.ptMax, &target.goal) != 4 ||
+      target.ptMin >= target.ptMax || target.goal <= 0.) {
+    printf("Error: bad precision target \"%s\", expected <histogram>:<ptMin>:<ptMax>:<relErr>\n", text);
+    return false;
+  }
+  target.name     = name;
+  target.hist     = NULL;
+  target.achieved = -1.;
+  return true;
+}
+
+// Look up the booked histograms of the targets by name
+
+bool FindPrecisionTargets(std::vector<PrecisionTarget> &targets)
+{
+  for (size_t it = 0; it < targets.size(); ++it) {
+    TH1 *h = dynamic_cast<TH1*>(gROOT->FindObject(targets[it].name.c_str()));
+    if (!h || h->GetDimension() > 2) {
+      printf("Error: precision target %s is not a booked 1D or 2D histogram\n",
+	     targets[it].name.c_str());
+      return false;
+    }
+    targets[it].hist = h;
+  }
+  return true;
+}
+
+// Update the achieved precisions; true if every target is met
+
+bool PrecisionReached(std::vector<PrecisionTarget> &targets)
+{
+  bool reached = true;
+  for (size_t it = 0; it < targets.size(); ++it) {
+    PrecisionTarget &t = targets[it];
+    TAxis *ptAxis = t.hist->GetDimension() == 1 ? t.hist->GetXaxis() : t.hist->GetYaxis();
+    int first = ptAxis->FindFixBin(t.ptMin);
+    int last  = ptAxis->FindFixBin(t.ptMax);
+    if (last > first && ptAxis->GetBinLowEdge(last) >= t.ptMax) last--;
+
+    double sum, err;
+    if (t.hist->GetDimension() == 1)
+      sum = t.hist->IntegralAndError(first, last, err);
+    else
+      sum = ((TH2*)t.hist)->IntegralAndError(1, t.hist->GetNbinsX(), first, last, err);
+
+    t.achieved = sum > 0. ? err/sum : -1.;
+    if (t.achieved < 0. || t.achieved > t.goal) reached = false;
+  }
+  return reached;
+}
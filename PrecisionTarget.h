@@ -0,0 +1,26 @@
+#ifndef PRECISIONTARGET_H
+#define PRECISIONTARGET_H
+
+#include <string>
+#include <vector>
+#include "TH1.h"
+
+// Target relative statistical uncertainty of the integral of a histogram
+// over a pT range, e.g. "hChiC2_pt_cndtn_3:2:10:0.05" for 5% on the chi_c2
+// yield at 2 < pT < 10 GeV. pT is the x axis of the pT spectra and the y
+// axis of the 2D mass spectra. Errors come from the Sumw2 arrays, so the
+// relative uncertainty does not depend on the cross-section normalisation.
+
+struct PrecisionTarget {
+  std::string name;
+  double      ptMin, ptMax;
+  double      goal;      // target relative uncertainty
+  TH1        *hist;
+  double      achieved;  // relative uncertainty at the last check, < 0 if empty
+};
+
+bool ParsePrecisionTarget(const char *text, PrecisionTarget &target);
+bool FindPrecisionTargets(std::vector<PrecisionTarget> &targets);
+bool PrecisionReached(std::vector<PrecisionTarget> &targets);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Species.h"
+#include "CutScan.h"
+#include "CounterRandom.h"
+#include "PileupPool.h"
+
+// A detector scenario: one compiled instantiation of AnalyseCandidate<Det>
+// with its own set of histograms. Every matched candidate of an event is
+// passed through all configured scenarios, so K scenarios share one
+// Pythia generation.
+
+typedef void (*AnalyseFunc)(const Pythia8::Event &, const SpeciesTable &, int,
+			    const std::vector<int> &, const RandomKey &, double,
+			    const PileupEvent *, HistSet &, CutScan *);
+
+struct Scenario {
+  std::string name;     // e.g. "ideal"
+  std::string suffix;   // histogram name suffix, "" for the realistic detector
+  AnalyseFunc analyse;
+  int         energy;   // index of the collision energy of its events
+  HistSet     hists;
+  CutScan     scan;
+  // with -subprocesses: one set per Pythia process code, booked on first
+  // use; fill points to the set of the current event
+  std::map<int,HistSet> process;
+  HistSet    *fill;
+};
+
+// Set up the scenarios of a comma-separated list such as "realistic,ideal".
+// Returns false for an unknown name.
+bool InitScenarios(const char *list, std::vector<Scenario> &scenarios);
+void ListScenarios();
+
+#endif
@@ -0,0 +1,52 @@
+#include "TRandom.h"
+#include <cstdio>
+
+// Seeds of the Pythia and smearing streams of one job.
+//
+// Campaign mode: job <job> of campaign <campaign> gets
+//   Pythia seed   1 + campaign*kMaxJobs + job       (Pythia accepts 1..900000000)
+//   smearing key  campaign << 32 | job              (Philox key, see CounterRandom.h)
+// Both maps are injective, so two different (campaign, job) pairs can never
+// share a stream, and a job can be rerun bit for bit from its manifest.
+//
+// Stand-alone mode keeps the old random Pythia seed; its smearing keys have
+// the top bit set and never coincide with campaign keys.
+//
+// With several collision energies (-energies) the generator of energy ie
+// gets the Pythia seed 1 + (pythiaSeed - 1 + ie*kEnergySeedStride) mod
+// 900000000, so the first energy keeps the seed of the job and the others
+// have streams of their own. They coincide with the first-energy streams of
+// campaign + ie*10000 only.
+
+const int kMaxJobs     = 10000;
+const int kMaxCampaign = 89999;
+const int kEnergySeedStride = 100000000;
+
+bool PartitionSeeds(int campaign, int job, int &pythiaSeed, ULong64_t &smearSeed)
+{
+  if (campaign < 0 || campaign > kMaxCampaign) {
+    printf("Error: campaign seed %d outside 0..%d\n", campaign, kMaxCampaign);
+    return false;
+  }
+  if (job < 0 || job >= kMaxJobs) {
+    printf("Error: job index %d outside 0..%d\n", job, kMaxJobs-1);
+    return false;
+  }
+  pythiaSeed = 1 + campaign*kMaxJobs + job;
+  smearSeed  = ((ULong64_t)campaign << 32) | (ULong64_t)job;
+  return true;
+}
+
+void RandomSeeds(int &pythiaSeed, ULong64_t &smearSeed)
+{
+  // Pythia random seed based on time does not work, take it from ROOT
+  TRandom rndm;
+  rndm.SetSeed(0);
+  pythiaSeed = 1 + rndm.Integer(1000000);
+  smearSeed  = (1ULL << 63) | (ULong64_t)pythiaSeed;
+}
+
+int EnergySeed(int pythiaSeed, int ie)
+{
+  return 1 + (int)(((ULong64_t)(pythiaSeed - 1) + (ULong64_t)ie*kEnergySeedStride) % 900000000ULL);
+}
@@ -0,0 +1,83 @@
+#ifndef SPECIES_H
+#define SPECIES_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "TH1.h"
+#include "TH2.h"
+#include "DecayPattern.h"
+#include "HistSpec.h"
+
+// Names and binning of the invariant-mass spectra shared by one family of
+// species, e.g. all chi_cJ -> J/psi gamma fill the same M(gamma e+e-) plots.
+// resName is M(resonance daughters), allName is M(all final legs), and
+// allName_mass_diff is the difference of both. The _pcm spectra take the
+// photons from their conversion pairs instead of the calorimeter. The
+// binning is that of the mass variables with "auto" axes in the histogram
+// spec (HistSpec.h).
+
+struct MassGroup {
+  std::string resName, resTitle; int nResBins;  double resMin,  resMax;
+  std::string allName, allTitle; int nAllBins;  double allMin,  allMax;
+  int nDiffBins; double diffMin, diffMax;
+};
+
+// Maximum number of final legs of a decay pattern
+const int kMaxLeg = 8;
+
+// One quarkonium state analysed via its decay-tree pattern
+
+struct Species {
+  std::string  name;    // histogram name tag, e.g. "ChiC2" for hChiC2_pt_all
+  std::string  title;   // latex title, e.g. "#chi_{c2}"
+  std::string  legTag;  // tag of final-leg histograms, e.g. "_chic0" for hGamma_chic0_pt_all
+  int          status;  // required status of the mother
+  double       br;      // weight of the decay-chain histograms
+  int          massGroup;
+  DecayPattern pattern;
+};
+
+struct SpeciesTable {
+  std::vector<Species>   species;
+  std::vector<MassGroup> massGroup;
+  std::map<int,int>      dispatch;  // mother PDG code -> index in species
+};
+
+// Histograms of one species, the enabled entries of the histogram spec
+
+struct SpeciesHists {
+  HistList mother;
+  HistList candidate;
+  std::vector<HistList> leg;  // one per final leg of the pattern
+};
+
+// All species and mass histograms of one output set
+
+struct HistSet {
+  std::vector<SpeciesHists> species;
+  std::vector<HistList>     mass;  // one per mass group
+};
+
+// Histograms filled once per run, outside the detector scenarios
+
+struct GlobalHists {
+  HistList electron;
+  HistList pi0;
+};
+
+void InitSpecies(SpeciesTable &table);
+void BookHistSet(const HistSpec &spec, const SpeciesTable &table, HistSet &hists, const char *suffix);
+void BookGlobalHists(const HistSpec &spec, GlobalHists &hists);
+// Normalise the xsec histograms, sigmaWeight = sigmaGen/nAccepted, dy the
+// rapidity window
+void ScaleHistSet(HistSet &hists, double sigmaWeight, double dy);
+void AddHistSet(HistSet &hists, const HistSet &other);
+// Write the histograms, appending their norms to norms (see HistSpec.h)
+void WriteHistSet(HistSet &hists, std::string &norms);
+void WriteGlobalHists(GlobalHists &hists, std::string &norms);
+
+void FillTrueCandidate(const Pythia8::Event &event, const SpeciesTable &table, int iSpecies,
+		       const std::vector<int> &iNode, double weight, const HistList &electron);
+
+#endif
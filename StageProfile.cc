@@ -0,0 +1,104 @@
+#include "StageProfile.h"
+
+#ifdef STAGE_PROFILE
+
+#include <cstdio>
+#include <cstring>
+
+StageStats gStageStats[kNStages];
+int        gCurrentStage = -1;
+
+static const char *kStageName[kNStages] = {
+  "generate", "particles", "match", "pileup", "smear", "acceptance", "mass", "fill", "print", "write"
+};
+
+#ifdef STAGE_PROFILE_COUNTERS
+
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static int gGroupFd = -2;  // -2 not opened yet, -1 not available
+
+// One counter group of this thread: cycles (leader), instructions, cache
+// misses, user space only so that it works at perf_event_paranoid <= 2
+
+static void OpenStageCounters()
+{
+  const ULong64_t config[kNCounters] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+  };
+  int fd[kNCounters];
+
+  gGroupFd = -1;
+  for (int k = 0; k < kNCounters; ++k) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.size           = sizeof(attr);
+    attr.config         = config[k];
+    attr.disabled       = (k == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP;
+    fd[k] = syscall(__NR_perf_event_open, &attr, 0, -1, k == 0 ? -1 : fd[0], 0);
+    if (fd[k] < 0) {
+      printf("Stage profile: perf_event_open failed (%s), no hardware counters\n", strerror(errno));
+      for (int m = 0; m < k; ++m) close(fd[m]);
+      return;
+    }
+  }
+  ioctl(fd[0], PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+  ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  gGroupFd = fd[0];
+}
+
+bool ReadStageCounters(ULong64_t *count)
+{
+  if (gGroupFd == -2) OpenStageCounters();
+  ULong64_t buf[1+kNCounters];  // number of counters, then the values
+  if (gGroupFd < 0 || read(gGroupFd, buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+    for (int k = 0; k < kNCounters; ++k) count[k] = 0;
+    return false;
+  }
+  for (int k = 0; k < kNCounters; ++k) count[k] = buf[1+k];
+  return true;
+}
+
+#endif
+
+void PrintStageProfile()
+{
+  ULong64_t dummy[kNCounters];
+  bool counters = ReadStageCounters(dummy);
+
+  double total = 0.;
+  for (int is = 0; is < kNStages; ++is)
+    total += gStageStats[is].time - gStageStats[is].childTime;
+
+  printf("\nStage profile (self excludes nested stages, %.3f s instrumented)\n", total);
+  printf("%-12s %12s %10s %10s %7s %10s", "stage", "calls", "incl [s]", "self [s]", "self %", "ns/call");
+  if (counters) printf(" %12s %6s %12s", "self Mcycles", "IPC", "misses/call");
+  printf("\n");
+  for (int is = 0; is < kNStages; ++is) {
+    const StageStats &s = gStageStats[is];
+    if (s.calls == 0) continue;
+    double self = s.time - s.childTime;
+    printf("%-12s %12llu %10.3f %10.3f %7.2f %10.1f", kStageName[is], s.calls, s.time, self,
+	   total > 0. ? 100.*self/total : 0., 1.e9*self/s.calls);
+    if (counters) {
+      ULong64_t cycles       = s.counter[0] - s.childCounter[0];
+      ULong64_t instructions = s.counter[1] - s.childCounter[1];
+      ULong64_t misses       = s.counter[2] - s.childCounter[2];
+      printf(" %12.1f %6.2f %12.2f", 1.e-6*cycles,
+	     cycles > 0 ? (double)instructions/cycles : 0., (double)misses/s.calls);
+    }
+    printf("\n");
+  }
+
+  return;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef STAGEPROFILE_H
+#define STAGEPROFILE_H
+
+#include "Rtypes.h"
+
+// Scoped per-stage profile of the event loop. PROFILE_STAGE(kStageX) at the
+// top of a scope charges the scope's wall time, and with counters also its
+// cycles, instructions and cache misses, to stage kStageX. Nested stages are
+// subtracted from the enclosing one, so the "self" columns add up to the
+// instrumented part of the run. PrintStageProfile() prints the table.
+//
+// Compiled out unless built with "make PROFILE=yes" (timers) or
+// "make PROFILE=counters" (timers and perf_event_open counters, Linux only).
+// Counter reads are system calls: time them against a PROFILE=yes build.
+
+enum ProfileStage {
+  kStageGenerate,    // pythia.next()
+  kStageParticles,   // scan of the event record
+  kStageMatch,       // decay-pattern matching
+  kStagePileup,      // pileup overlay and combinations
+  kStageSmear,       // detector smearing
+  kStageAcceptance,  // acceptance checks
+  kStageMass,        // invariant-mass spectra
+  kStageFill,        // other histogram fills
+  kStagePrint,       // event listings and debug printout
+  kStageWrite,       // output file
+  kNStages
+};
+
+#ifdef STAGE_PROFILE
+
+#include <time.h>
+
+const int kNCounters = 3;  // cycles, instructions, cache misses
+
+struct StageStats {
+  ULong64_t calls;
+  double    time, childTime;  // seconds
+  ULong64_t counter[kNCounters], childCounter[kNCounters];
+};
+
+extern StageStats gStageStats[kNStages];
+extern int        gCurrentStage;  // innermost open stage, -1 if none
+
+#ifdef STAGE_PROFILE_COUNTERS
+bool ReadStageCounters(ULong64_t *count);
+#else
+inline bool ReadStageCounters(ULong64_t *count)
+{
+  for (int k = 0; k < kNCounters; ++k) count[k] = 0;
+  return false;
+}
+#endif
+
+class StageTimer {
+ public:
+  StageTimer(int stage) : fStage(stage), fParent(gCurrentStage) {
+    gCurrentStage = stage;
+    ReadStageCounters(fCount);
+    fStart = Now();
+  }
+
+  ~StageTimer() {
+    double dt = Now() - fStart;
+    ULong64_t count[kNCounters];
+    ReadStageCounters(count);
+    StageStats &s = gStageStats[fStage];
+    s.calls++;
+    s.time += dt;
+    for (int k = 0; k < kNCounters; ++k) s.counter[k] += count[k] - fCount[k];
+    if (fParent >= 0) {
+      StageStats &p = gStageStats[fParent];
+      p.childTime += dt;
+      for (int k = 0; k < kNCounters; ++k) p.childCounter[k] += count[k] - fCount[k];
+    }
+    gCurrentStage = fParent;
+  }
+
+  static double Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.e-9*ts.tv_nsec;
+  }
+
+ private:
+  int       fStage;
+  int       fParent;
+  double    fStart;
+  ULong64_t fCount[kNCounters];
+};
+
+void PrintStageProfile();
+
+#define PROFILE_STAGE_NAME2(line) stageTimer_##line
+#define PROFILE_STAGE_NAME(line)  PROFILE_STAGE_NAME2(line)
+#define PROFILE_STAGE(stage)      StageTimer PROFILE_STAGE_NAME(__LINE__)(stage)
+
+#else
+
+#define PROFILE_STAGE(stage)
+inline void PrintStageProfile() {}
+
+#endif
+
+#endif
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Usage: makeQueue.sh <dir> <campaignSeed> <nChunks> <chunkEvents> [leaseTimeout]
+# Create the event-chunk queue of a campaign on the shared file system.
+# Jobs started with "pythia_chic2.exe -queue <dir> 0" (runBulk.sh <seed> <dir>)
+# lease chunks until none is left, so fast nodes simply take more chunks.
+# Chunk c is generated with the streams of job c of the campaign. Keep a
+# chunk well below the lease timeout (seconds, default 3 hours) and the
+# batch wall time; a job that dies or runs out of wall time leaves its
+# leases behind, and they are taken over once expired. Progress:
+#   ls <dir>/todo <dir>/leased <dir>/done
+
+DIR=${1:?"Usage: makeQueue.sh <dir> <campaignSeed> <nChunks> <chunkEvents> [leaseTimeout]"}
+CAMPAIGN=${2:?"campaign seed missing"}
+NCHUNKS=${3:?"number of chunks missing"}
+CHUNKEVENTS=${4:?"events per chunk missing"}
+TIMEOUT=${5:-10800}
+
+if [ -e $DIR/queue ]; then
+    echo "Error: $DIR already holds a queue"
+    exit 1
+fi
+if [ $NCHUNKS -gt 10000 ]; then
+    echo "Error: at most 10000 chunks per campaign"
+    exit 1
+fi
+
+mkdir -p $DIR/todo $DIR/leased $DIR/done || exit 1
+for ((c = 0; c < NCHUNKS; c++))
+do
+    touch $DIR/todo/$c
+done
+# written last: jobs refuse a queue without it
+cat > $DIR/queue <<END
+campaign = $CAMPAIGN
+chunks = $NCHUNKS
+chunkEvents = $CHUNKEVENTS
+leaseTimeout = $TIMEOUT
+END
+echo "Queue $DIR: campaign $CAMPAIGN, $NCHUNKS chunks of $CHUNKEVENTS events"
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Usage: mergeCampaign.sh <merged.root> <job1/pythia_chic2.root> ...
+# Merge the outputs of a campaign with hadd after checking their manifests:
+# every input must have a manifest, all settings hashes must agree and no
+# random stream (job or queue chunk) may appear twice.
+
+OUT=${1:?"Usage: mergeCampaign.sh <merged.root> <inputs.root> ..."}
+shift
+
+MANIFESTS=""
+for f in "$@"
+do
+    m=${f%.root}.manifest
+    if [ ! -f $m ]; then
+	echo "Error: no manifest $m for $f"
+	exit 1
+    fi
+    MANIFESTS="$MANIFESTS $m"
+done
+
+HASHES=`grep -h "^settingsHash = " $MANIFESTS | sort -u | wc -l`
+if [ "$HASHES" != "1" ]; then
+    echo "Error: inputs were produced with different settings:"
+    grep "^settingsHash = " $MANIFESTS
+    exit 1
+fi
+
+# streams are "stream = <pythiaSeed>/<smearSeed>"; a Pythia seed may not
+# repeat either, whatever its smearing key
+for key in "stream = [^ ]*" "stream = [^/]*/"
+do
+    DUPS=`grep -ho "^$key" $MANIFESTS | sort | uniq -d`
+    if [ -n "$DUPS" ]; then
+	echo "Error: duplicate random streams, the same statistics would be counted twice:"
+	echo "$DUPS" | while read d
+	do
+	    echo "$d in" `grep -l "^$d" $MANIFESTS`
+	done
+	exit 1
+    fi
+done
+
+hadd -f $OUT "$@" || exit 1
+
+# merged manifest: the list of all merged job manifests
+cat $MANIFESTS > ${OUT%.root}.manifest
+echo "Merged $# jobs into $OUT"
+echo "Histograms are summed as by hadd: divide cross-section spectra by $# to average the jobs,"
+echo "or for jobs of unequal size (queue mode) weight each job by its nAccepted before merging"
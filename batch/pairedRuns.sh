@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# Usage: pairedRuns.sh <nEvents> "<reference options>" "<candidate options>" [alpha]
+# Short paired runs of pythia_chic2.exe, e.g. the reference loop against a
+# faster mode, compared statistically with CompareOutputs.C. The two runs
+# use independent streams (jobs 0 and 1 of a fresh campaign), so the tests
+# see genuine statistical fluctuations. Exits with 1 if the outputs differ
+# significantly. Run from the directory of pythia_chic2.exe.
+
+NEVENTS=${1:?"Usage: pairedRuns.sh <nEvents> \"<reference options>\" \"<candidate options>\" [alpha]"}
+REFOPT=$2
+NEWOPT=$3
+ALPHA=${4:-0.01}
+CAMPAIGN=$((RANDOM % 89999))
+DIR=paired.$CAMPAIGN
+
+mkdir -p $DIR/ref $DIR/new || exit 1
+echo "Paired runs in $DIR, campaign $CAMPAIGN, $NEVENTS events each"
+
+(cd $DIR/ref && ../../pythia_chic2.exe $REFOPT -campaign $CAMPAIGN -job 0 $NEVENTS >& pythia_chic2.log) &
+(cd $DIR/new && ../../pythia_chic2.exe $NEWOPT -campaign $CAMPAIGN -job 1 $NEVENTS >& pythia_chic2.log) &
+wait
+
+root -l -b -q "CompareOutputs.C(\"$DIR/ref/pythia_chic2.root\",\"$DIR/new/pythia_chic2.root\",$ALPHA)" \
+    | tee $DIR/compare.log
+grep -q "^RESULT: PASS" $DIR/compare.log
@@ -12,11 +12,18 @@ alienv enter VO_ALICE@AliPhysics::vAN-20181201-1
 echo PATH=$PATH
 echo LD_LIBRARY_PATH=$LD_LIBRARY_PATH
 
-WDIR=$PBS_O_WORKDIR/job001
+JOB=job001
+WDIR=$PBS_O_WORKDIR/$JOB
 mkdir -pv $WDIR
 cd $WDIR
 echo "Current directory: "`pwd`", hostname "`hostname`
 rm -rf *
 export PYTHIA8DATA=$ALICE_ROOT/PYTHIA8/pythia8210/xmldoc
-time .././pythia_chic2.exe 10000000 >& pythia_chic2.log
+if [ -n "$QUEUE" ]; then
+    # lease event chunks from the campaign queue until it is empty
+    time .././pythia_chic2.exe -queue $QUEUE 0 >& pythia_chic2.log
+else
+    # campaign seed from runBulk.sh, job index from the directory name
+    time .././pythia_chic2.exe -campaign $CAMPAIGN -job ${JOB#job} 10000000 >& pythia_chic2.log
+fi
 ls -al
@@ -0,0 +1,267 @@
+// Benchmark of the analysis kernels and of the event loop, see "make bench".
+// Fixed seeds and synthetic inputs: every run times the same work. Kernel
+// timings are the best of several repetitions, in ns per call; the event
+// loop is timed on a short Pythia run with the realistic detector.
+// Results are written as flat JSON and compared with a baseline file.
+
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <time.h>
+#include <unistd.h>
+
+#include "Pythia8/Pythia.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "TMath.h"
+#include "TRandom3.h"
+#include "TROOT.h"
+#include "TLorentzVector.h"
+
+#include "Species.h"
+#include "CutScan.h"
+#include "AnalyseCandidate.h"
+
+using namespace Pythia8;
+
+void Init(Pythia*, int, double, const char *, bool, std::string &);
+Double_t smearE(Double_t, const RandomKey &);
+Double_t smearP(Double_t, const RandomKey &);
+Double_t smearX(Double_t, Double_t, const RandomKey &);
+TLorentzVector resolutionPhoton  (TLorentzVector, const RandomKey &);
+TLorentzVector resolutionElectron(TLorentzVector, const RandomKey &);
+
+struct BenchResult {
+  std::string name;
+  double      value;
+  bool        higherIsBetter;
+};
+
+static volatile double gSink;  // keeps the timed results alive
+
+static double Now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.e-9*ts.tv_nsec;
+}
+
+static void AddResult(std::vector<BenchResult> &results, const char *name, double value,
+		      bool higherIsBetter)
+{
+  BenchResult r;
+  r.name           = name;
+  r.value          = value;
+  r.higherIsBetter = higherIsBetter;
+  results.push_back(r);
+  printf("%-40s %12.2f\n", name, value);
+}
+
+// Best of nRepeat timings of body over the nCalls inputs, in ns per call
+#define BENCH_KERNEL(name, body)					\
+  {									\
+    double best = 1.e30;						\
+    for (int rep = 0; rep < nRepeat; ++rep) {				\
+      double t0 = Now();						\
+      double sum = 0.;							\
+      for (int i = 0; i < nCalls; ++i) { body; }			\
+      best = TMath::Min(best, Now() - t0);				\
+      gSink = gSink + sum;						\
+    }									\
+    AddResult(results, name ".ns_per_call", 1.e9*best/nCalls, false);	\
+  }
+
+// Read "name": value pairs of a flat JSON file, other entries are skipped
+
+static bool ReadBaseline(const char *fileName, std::vector<BenchResult> &baseline)
+{
+  FILE *f = fopen(fileName, "r");
+  if (!f) {
+    printf("Error: cannot read baseline %s\n", fileName);
+    return false;
+  }
+  char line[512], name[256];
+  double value;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, " \"%255[^\"]\" : %lf", name, &value) != 2) continue;
+    BenchResult r;
+    r.name           = name;
+    r.value          = value;
+    r.higherIsBetter = false;
+    baseline.push_back(r);
+  }
+  fclose(f);
+  return true;
+}
+
+// Compare with the baseline; false if any result is worse by more than tolerance
+
+static bool CompareBaseline(const std::vector<BenchResult> &results,
+			    const std::vector<BenchResult> &baseline, double tolerance)
+{
+  bool ok = true;
+  printf("\n%-40s %12s %12s %8s\n", "benchmark", "result", "baseline", "ratio");
+  for (size_t ir = 0; ir < results.size(); ++ir) {
+    const BenchResult &r = results[ir];
+    const BenchResult *b = NULL;
+    for (size_t ib = 0; ib < baseline.size(); ++ib)
+      if (baseline[ib].name == r.name) b = &baseline[ib];
+    if (!b || b->value <= 0.) {
+      printf("%-40s %12.2f %12s\n", r.name.c_str(), r.value, "-");
+      continue;
+    }
+    // ratio > 1 is always a slowdown
+    double ratio = r.higherIsBetter ? b->value / r.value : r.value / b->value;
+    bool worse = ratio > 1. + tolerance;
+    printf("%-40s %12.2f %12.2f %8.3f%s\n", r.name.c_str(), r.value, b->value, ratio,
+	   worse ? "  REGRESSION" : "");
+    if (worse) ok = false;
+  }
+  return ok;
+}
+
+static bool WriteResults(const char *fileName, const std::vector<BenchResult> &results,
+			 int nCalls, int nEvents)
+{
+  FILE *f = fopen(fileName, "w");
+  if (!f) {
+    printf("Error: cannot write %s\n", fileName);
+    return false;
+  }
+  char host[256];
+  if (gethostname(host, sizeof(host)) != 0) strcpy(host, "unknown");
+  host[sizeof(host)-1] = 0;
+  fprintf(f, "{\n  \"host\": \"%s\",\n  \"calls\": %d,\n  \"events\": %d", host, nCalls, nEvents);
+  for (size_t ir = 0; ir < results.size(); ++ir)
+    fprintf(f, ",\n  \"%s\": %.4g", results[ir].name.c_str(), results[ir].value);
+  fprintf(f, "\n}\n");
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+
+  const char *outName      = "bench.json";
+  const char *baselineName = NULL;
+  double tolerance = 0.10;
+  int    nCalls    = 200000;
+  int    nEvents   = 2000;
+  const int nRepeat = 5;
+  for (int iArg = 1; iArg < argc; ++iArg) {
+    if      (!strcmp(argv[iArg], "-o")         && iArg+1 < argc) outName      = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-baseline")  && iArg+1 < argc) baselineName = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-tolerance") && iArg+1 < argc) tolerance    = atof(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-calls")     && iArg+1 < argc) nCalls       = atoi(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-events")    && iArg+1 < argc) nEvents      = atoi(argv[++iArg]);
+    else {
+      printf("Usage: %s [-o <out.json>] [-baseline <baseline.json>] [-tolerance <fraction>]\n", argv[0]);
+      printf("       [-calls <kernel calls>] [-events <Pythia events, 0 to skip>]\n");
+      printf("       exits with 2 if a result is slower than the baseline by more than\n");
+      printf("       the tolerance, default 0.10\n");
+      return 1;
+    }
+  }
+
+  // Synthetic inputs: photons and electrons of 0.5-20 GeV within |eta|<0.8
+  TRandom3 rndm(12345);
+  std::vector<TLorentzVector> pGam(nCalls), pEle(nCalls), pRes(nCalls), pAll(nCalls);
+  std::vector<double> energy(nCalls), coord(nCalls), cutVar(kScanVars*nCalls);
+  std::vector<RandomKey> key(nCalls);
+  for (int i = 0; i < nCalls; ++i) {
+    double e1 = 0.5 + 19.5*rndm.Rndm(), e2 = 0.5 + 19.5*rndm.Rndm();
+    double eta1 = rndm.Uniform(-0.8, 0.8), eta2 = rndm.Uniform(-0.8, 0.8);
+    double phi1 = rndm.Uniform(0., TMath::TwoPi()), phi2 = rndm.Uniform(0., TMath::TwoPi());
+    pGam[i].SetPtEtaPhiM(e1/TMath::CosH(eta1), eta1, phi1, 0.);
+    pEle[i].SetPtEtaPhiM(e2/TMath::CosH(eta2), eta2, phi2, 0.000511);
+    pRes[i] = pEle[i] + pEle[(i+1) % nCalls];
+    pAll[i] = pRes[i] + pGam[i];
+    energy[i] = e1;
+    coord[i]  = rndm.Uniform(-50., 50.);
+    cutVar[kScanVars*i]   = pEle[i].Pt();
+    cutVar[kScanVars*i+1] = pEle[i].E();
+    cutVar[kScanVars*i+2] = pGam[i].E();
+    key[i].seed     = 1;
+    key[i].event    = i;
+    key[i].particle = 0;
+  }
+
+  SpeciesTable species;
+  InitSpecies(species);
+  HistSpec histSpec;
+  if (!ReadHistSpec(NULL, histSpec)) return 1;
+  HistSet hists;
+  BookHistSet(histSpec, species, hists, "_bench");
+  CutScan scan;
+  BookCutScan(species, scan, "_bench");
+  const HistList &mass = hists.mass[0];
+  const unsigned int conds = kCondAll | kCondCndtn1 | kCondCndtn2 | kCondCndtn3;
+  TH1 *hPt   = (TH1*)gROOT->FindObject("hChiC2_pt_all_bench");
+  TH2 *hDiff = (TH2*)gROOT->FindObject("hMassGamElecPosi_mass_diff_bench");
+  bool inAcc[kScanCndtn] = {true, true};
+
+  std::vector<BenchResult> results;
+  printf("\n%-40s %12s\n", "benchmark", "result");
+
+  BENCH_KERNEL("smearE",             sum += smearE(energy[i], key[i]));
+  BENCH_KERNEL("smearP",             sum += smearP(energy[i], key[i]));
+  BENCH_KERNEL("smearX",             sum += smearX(coord[i], energy[i], key[i]));
+  BENCH_KERNEL("resolutionPhoton",   sum += resolutionPhoton(pGam[i], key[i]).E());
+  BENCH_KERNEL("resolutionElectron", sum += resolutionElectron(pEle[i], key[i]).E());
+  BENCH_KERNEL("IsPhotonDetectedInPHOS",  sum += IsPhotonDetectedInPHOS(pGam[i], 1.));
+  BENCH_KERNEL("IsPhotonDetectedInEMCAL", sum += IsPhotonDetectedInEMCAL(pEle[i], 2.));
+  BENCH_KERNEL("IsElectronDetectedInCTS", sum += IsElectronDetectedInCTS(pEle[i], 1.));
+  BENCH_KERNEL("Invariant_mass_spectr_creator",
+	       Invariant_mass_spectr_creator(pRes[i], pAll[i], conds, mass, 0.01, 1.));
+  BENCH_KERNEL("fill.TH1F",          hPt->Fill(pGam[i].Pt(), 0.01));
+  BENCH_KERNEL("fill.TH2F",          hDiff->Fill(pAll[i].M() - pRes[i].M(), pAll[i].Pt(), 0.01));
+  BENCH_KERNEL("fill.CutScan",
+	       FillCutScan(scan, 0, 0, inAcc, &cutVar[kScanVars*i], pAll[i].M() - pRes[i].M(), 0.01));
+
+  // End to end: generation and the realistic analysis of every candidate
+  if (nEvents > 0) {
+    Pythia pythia;
+    std::string settings;
+    Init(&pythia, 12345, 13000., NULL, false, settings);
+    HistSet loopHists;
+    BookHistSet(histSpec, species, loopHists, "_bench_loop");
+    RandomKey eventKey = {1, 0, 0};
+    std::vector<int> iNode;
+
+    double t0 = Now();
+    for (int iEvent = 0; iEvent < nEvents; ++iEvent) {
+      if (!pythia.next()) continue;
+      eventKey.event = iEvent;
+      for (int i = 0; i < pythia.event.size(); ++i) {
+	std::map<int,int>::const_iterator is = species.dispatch.find(pythia.event[i].id());
+	if (is == species.dispatch.end()) continue;
+	const Species &sp = species.species[is->second];
+	if (pythia.event[i].status() != sp.status || fabs(pythia.event[i].y()) > 0.5) continue;
+	double var[kNVars];
+	var[kVarPt]  = pythia.event[i].pT();
+	var[kVarY]   = pythia.event[i].y();
+	var[kVarPhi] = PhiPositive(pythia.event[i].phi());
+	FillHistList(loopHists.species[is->second].mother, kCondAll, var, sp.br, 1.);
+	if (MatchDecayPattern(pythia.event, i, sp.pattern, iNode))
+	  AnalyseCandidate<RealisticDetector>(pythia.event, species, is->second, iNode, eventKey,
+					      1., NULL, loopHists, NULL);
+      }
+    }
+    double dt = Now() - t0;
+    AddResult(results, "eventLoop.events_per_s", nEvents/dt, true);
+  }
+
+  if (!WriteResults(outName, results, nCalls, nEvents)) return 1;
+  printf("\nResults written to %s\n", outName);
+
+  if (baselineName) {
+    std::vector<BenchResult> baseline;
+    if (!ReadBaseline(baselineName, baseline)) return 1;
+    if (!CompareBaseline(results, baseline, tolerance)) {
+      printf("\nSlower than the baseline %s by more than %.0f%%\n", baselineName, 100.*tolerance);
+      return 2;
+    }
+  }
+
+  return 0;
+}
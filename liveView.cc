@@ -0,0 +1,108 @@
+// Look into running pythia_chic2.exe -live jobs: read a consistent snapshot
+// of every snapshot file given, see LiveSnapshot.h, print the state of the
+// jobs and the Delta M peaks, and write the histograms, summed over the jobs
+// of equal settings, to a ROOT file for DrawHistograms.C, FitDeltaM.C etc.
+// The contents are weighted counts, not yet cross sections.
+//
+//   liveView.exe [-o <out.root>] <snapshot file> [<snapshot file> ...]
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+#include "LiveSnapshot.h"
+
+int main(int argc, char* argv[]) {
+
+  const char *outName = "liveView.root";
+  int iArg = 1;
+  if (iArg + 1 < argc && !strcmp(argv[iArg], "-o")) {
+    outName = argv[iArg + 1];
+    iArg += 2;
+  }
+  if (iArg >= argc) {
+    printf("Usage: %s [-o <out.root>, default liveView.root] <snapshot file> ...\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<TH1*> total;
+  std::map<std::string, TH1*> byName;
+  ULong64_t settingsHash = 0;
+  ULong64_t nEvents = 0;
+  int nMerged = 0;
+  double now = time(NULL);
+
+  printf("\n%-40s %8s %-9s %12s %10s %9s %10s\n", "snapshot", "pid", "state",
+	 "events", "events/s", "age [s]", "sigma [mb]");
+  for (; iArg < argc; ++iArg) {
+    LiveHeader header;
+    LiveStatus status;
+    std::vector<TH1*> hists;
+    if (!ReadLiveSnapshot(argv[iArg], header, status, hists)) continue;
+
+    const char *state = "running";
+    if (header.finished) state = "finished";
+    else if (kill(header.pid, 0) != 0 && errno == ESRCH) state = "died";
+    double elapsed = status.time - header.startTime;
+    // jobs of several energies publish no single cross section
+    char sigma[32] = "-";
+    if (status.sigmaGen > 0.) sprintf(sigma, "%.4g", status.sigmaGen);
+    printf("%-40s %8u %-9s %12llu %10.1f %9.0f %10s\n", argv[iArg], header.pid, state,
+	   status.nEvents, elapsed > 0. ? status.nEvents/elapsed : 0., now - status.time, sigma);
+
+    // only snapshots of equal settings are merged
+    if (nMerged == 0) {
+      settingsHash = header.settingsHash;
+      total = hists;
+      for (size_t ih = 0; ih < hists.size(); ++ih) byName[hists[ih]->GetName()] = hists[ih];
+    } else if (header.settingsHash != settingsHash) {
+      printf("  Warning: settings hash %016llx differs from %016llx, not merged\n",
+	     header.settingsHash, settingsHash);
+      for (size_t ih = 0; ih < hists.size(); ++ih) delete hists[ih];
+      continue;
+    } else {
+      for (size_t ih = 0; ih < hists.size(); ++ih) {
+	std::map<std::string, TH1*>::iterator it = byName.find(hists[ih]->GetName());
+	if (it != byName.end() && it->second->GetNcells() == hists[ih]->GetNcells())
+	  it->second->Add(hists[ih]);
+	delete hists[ih];
+      }
+    }
+    nEvents += status.nEvents;
+    nMerged++;
+  }
+  if (nMerged == 0) return 1;
+
+  // Delta M peaks of the mass spectra, projected over all pT
+  printf("\n%d snapshot(s) merged, %llu events\n\n", nMerged, nEvents);
+  printf("%-50s %12s %10s %10s %10s\n", "Delta M", "weighted", "peak", "mean", "RMS");
+  for (size_t ih = 0; ih < total.size(); ++ih) {
+    TH2 *h = dynamic_cast<TH2*>(total[ih]);
+    if (!h || !strstr(h->GetName(), "_mass_diff")) continue;
+    TH1D *dm = h->ProjectionX("liveView_dm");
+    dm->SetDirectory(0);
+    printf("%-50s %12.4g %10.4f %10.4f %10.4f\n", h->GetName(), dm->Integral(),
+	   dm->GetXaxis()->GetBinCenter(dm->GetMaximumBin()), dm->GetMean(), dm->GetRMS());
+    delete dm;
+  }
+
+  TFile *out = new TFile(outName, "RECREATE");
+  if (out->IsZombie()) {
+    printf("Error: cannot write %s\n", outName);
+    return 1;
+  }
+  for (size_t ih = 0; ih < total.size(); ++ih) total[ih]->Write();
+  out->Close();
+  printf("\n%d histograms written to %s\n", (int)total.size(), outName);
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+// Generate a pool of minimum-bias events for the pileup overlay of
+// pythia_chic2.exe -pileup, see PileupPool.h. One pool serves any number of
+// signal runs: a pool of a few 10^5 events, rotated at random, is reused
+// many times without visible repetition.
+//
+//   mkPileupPool.exe <pool file> <nEvents> [seed] [eCM]
+
+#include <iostream>
+#include <cstring>
+#include <vector>
+
+#include "Pythia8/Pythia.h"
+#include "PileupPool.h"
+
+using namespace Pythia8;
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 3 || argc > 5 || atoi(argv[2]) <= 0) {
+    printf("Usage: %s <pool file> <nEvents> [seed, default 1] [eCM/GeV, default 13000]\n", argv[0]);
+    return 1;
+  }
+  const char *fileName = argv[1];
+  const int nEvents = atoi(argv[2]);
+  int seed   = argc > 3 ? atoi(argv[3]) : 1;
+  double eCM = argc > 4 ? atof(argv[4]) : 13000.;
+  // the calorimeters lie within |eta| < 0.7
+  const double etaMax = 1.;
+
+  Pythia pythia;
+  char line[80];
+  pythia.readString("Random:setSeed = on");
+  sprintf(line, "Random:Seed = %d", seed);
+  pythia.readString(line);
+  pythia.readString("SoftQCD:inelastic = on");
+  sprintf(line, "Beams:eCM = %g", eCM);
+  pythia.readString(line);
+  pythia.readString("Next:numberCount = 10000");
+  pythia.init();
+
+  FILE *f = fopen(fileName, "wb");
+  if (!f) {
+    printf("Error: cannot write %s\n", fileName);
+    return 1;
+  }
+  PileupPoolHeader header;
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, "CHICPU1");
+  header.nEvents = nEvents;
+  header.eCM     = eCM;
+  header.etaMax  = etaMax;
+
+  // the offsets are written once all events are known
+  std::vector<ULong64_t> offset(nEvents + 1, 0);
+  fseek(f, sizeof(header) + offset.size()*sizeof(ULong64_t), SEEK_SET);
+
+  ULong64_t nPhotons = 0;
+  for (int iEvent = 0; iEvent < nEvents; ) {
+    if (!pythia.next()) continue;
+    offset[iEvent] = nPhotons;
+    for (int i = 0; i < pythia.event.size(); ++i) {
+      const Particle &p = pythia.event[i];
+      if (!p.isFinal() || p.id() != 22 || fabs(p.eta()) > etaMax) continue;
+      PileupPhoton g = {(float)p.px(), (float)p.py(), (float)p.pz()};
+      fwrite(&g, sizeof(g), 1, f);
+      nPhotons++;
+    }
+    iEvent++;
+  }
+  offset[nEvents] = nPhotons;
+  header.nPhotons = nPhotons;
+
+  fseek(f, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, f);
+  fwrite(&offset[0], sizeof(ULong64_t), offset.size(), f);
+  bool failed = ferror(f) != 0;
+  if (fclose(f) != 0 || failed) {
+    printf("Error: cannot write %s\n", fileName);
+    return 1;
+  }
+  pythia.stat();
+  printf("Pileup pool %s: %d events, %.1f photons per event within |eta| < %g\n",
+	 fileName, nEvents, (double)nPhotons/nEvents, etaMax);
+
+  return 0;
+}
@@ -1,6 +1,8 @@
 
 // Stdlib header file for input and output.
 #include <iostream>
+#include <cstring>
+#include <climits>
 
 // Header file to access Pythia 8 program elements.
 // #include "Pythia8/Pythia.h"
@@ -20,772 +22,678 @@
 
 // ROOT, for saving file.
 #include "TFile.h"
+#include "TROOT.h"
+#include "TObjString.h"
 
 #include "TLorentzVector.h"
 
-using namespace Pythia8;
-
-void Init(Pythia*);
-void Invariant_mass_spectr_creator(TLorentzVector, TLorentzVector, TLorentzVector,
-				   TH2F *, TH2F *, TH2F *, TH2F *, TH2F *, TH2F *, TH2F *, TH2F *, TH2F *, double);
-TLorentzVector resolutionPhoton  (TLorentzVector);
-TLorentzVector resolutionElectron(TLorentzVector);
+#include "Species.h"
+#include "CutScan.h"
+#include "Scenario.h"
+#include "CounterRandom.h"
+#include "EventQueue.h"
+#include "PrecisionTarget.h"
+#include "StageProfile.h"
+#include "HepMCInput.h"
+#include "PileupPool.h"
+#include "CaloGeometry.h"
+#include "LiveSnapshot.h"
 
-bool IsElectronDetectedInCTS(TLorentzVector);
-bool IsPhotonDetectedInEMCAL(TLorentzVector);
-bool IsPhotonDetectedInPHOS (TLorentzVector); 
+using namespace Pythia8;
 
+void Init(Pythia*, int, double, const char *, bool, std::string &);
+bool PartitionSeeds(int, int, int &, ULong64_t &);
+void RandomSeeds(int &, ULong64_t &);
+int  EnergySeed(int, int);
+ULong64_t SettingsHash(const std::string &);
+void WriteManifest(const char *, TFile *, const std::string &);
+TLorentzVector resolutionPhoton  (TLorentzVector, const RandomKey &);
+
+// Status of the run for the live snapshots: nAccepted summed over the
+// generators of all energies, sigmaGen only for a single one (else 0)
+
+static LiveStatus RunStatus(const std::vector<Pythia*> &generators, int nEvents)
+{
+  LiveStatus status = {(ULong64_t)nEvents, 0, 0., 0.};
+  for (size_t ie = 0; ie < generators.size(); ++ie)
+    status.nAccepted += generators[ie]->info.nAccepted();
+  if (generators.size() == 1) status.sigmaGen = generators[0]->info.sigmaGen();
+  return status;
+}
 
 
 int main(int argc, char* argv[]) {
 
   // read input parameters
   printf("argc = %d, argv[0] = %s\n",argc,argv[0]);
-  if (argc != 2) {
-    printf("Usage: %s <nEvents>\n",argv[0]);
+  bool scanMode = false;
+  const char *scenarioList = "realistic";
+  int campaign = -1;
+  int job      = 0;
+  const char *queueDir = NULL;
+  std::vector<PrecisionTarget> targets;
+  int checkEvery = 10000;
+  const char *inputFile = NULL;
+  bool decayOnly = false;
+  const char *pileupFile = NULL;
+  double pileupMu = 0.;
+  bool splitProcesses = false;
+  const char *energyList = "13000";
+  const char *deadMapFile = NULL;
+  double sigmaZ = 0.;
+  const char *liveFile = NULL;
+  const char *histSpecFile = NULL;
+  double liveEvery = 60.;
+  int iArg = 1;
+  for (; iArg < argc && argv[iArg][0] == '-'; ++iArg) {
+    if (!strcmp(argv[iArg], "-scan")) scanMode = true;
+    else if (!strcmp(argv[iArg], "-scenarios") && iArg+1 < argc) scenarioList = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-campaign")  && iArg+1 < argc) campaign = atoi(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-job")       && iArg+1 < argc) job      = atoi(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-queue")     && iArg+1 < argc) queueDir = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-check")     && iArg+1 < argc) checkEvery = atoi(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-input")     && iArg+1 < argc) inputFile  = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-decayOnly")) decayOnly = true;
+    else if (!strcmp(argv[iArg], "-subprocesses")) splitProcesses = true;
+    else if (!strcmp(argv[iArg], "-energies")  && iArg+1 < argc) energyList = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-deadMap")   && iArg+1 < argc) deadMapFile = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-sigmaZ")    && iArg+1 < argc) sigmaZ      = atof(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-pileup")    && iArg+1 < argc) pileupFile = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-mu")        && iArg+1 < argc) pileupMu   = atof(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-live")      && iArg+1 < argc) liveFile  = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-liveEvery") && iArg+1 < argc) liveEvery = atof(argv[++iArg]);
+    else if (!strcmp(argv[iArg], "-hists")     && iArg+1 < argc) histSpecFile = argv[++iArg];
+    else if (!strcmp(argv[iArg], "-target")    && iArg+1 < argc) {
+      PrecisionTarget target;
+      if (!ParsePrecisionTarget(argv[++iArg], target)) return 1;
+      targets.push_back(target);
+    }
+    else break;
+  }
+  // external events: HepMC3 files are analysed as they are, LHEF files
+  // are showered, hadronised and decayed by Pythia
+  bool hepmcInput = inputFile && strstr(inputFile, ".hepmc");
+  bool lhefInput  = inputFile && strstr(inputFile, ".lhe");
+  // collision energies [GeV], generated in turn event by event
+  std::vector<double> energies;
+  bool energiesOk = true;
+  for (const char *e = energyList; e; e = strchr(e, ',') ? strchr(e, ',') + 1 : NULL) {
+    double eCM = atof(e);
+    for (size_t ie = 0; ie < energies.size(); ++ie)
+      if (energies[ie] == eCM) energiesOk = false;
+    if (eCM <= 0.) energiesOk = false;
+    energies.push_back(eCM);
+  }
+  std::vector<Scenario> scenarios;
+  if (argc - iArg != 1 || checkEvery <= 0 || !InitScenarios(scenarioList, scenarios) ||
+      (inputFile && !hepmcInput && !lhefInput) || (inputFile && queueDir) ||
+      (decayOnly && !lhefInput) || (pileupFile != NULL) != (pileupMu > 0.) || pileupMu > 200. ||
+      (splitProcesses && (inputFile || !targets.empty())) || !energiesOk ||
+      (energies.size() > 1 && (inputFile || splitProcesses)) || sigmaZ < 0. ||
+      (sigmaZ > 0. && hepmcInput) || liveEvery <= 0.) {
+    printf("Usage: %s [-scan] [-scenarios <list>] [-campaign <seed> -job <index> | -queue <dir>]\n",argv[0]);
+    printf("       [-target <histogram>:<ptMin>:<ptMax>:<relErr> ... [-check <nEvents>]]\n");
+    printf("       [-input <file.hepmc|file.lhe>[.gz] [-decayOnly]] [-pileup <pool> -mu <mean>]\n");
+    printf("       [-subprocesses] [-energies <eCM>,<eCM>,...] [-deadMap <file>] [-sigmaZ <cm>]\n");
+    printf("       [-live <file> [-liveEvery <s>]] [-hists <spec>]\n");
+    printf("       <nEvents>\n");
     printf("       <nEvents>=0 is the number of events to generate.\n");
+    printf("       -scan   fill cumulative cut-threshold scan histograms\n");
+    printf("       -scenarios  comma-separated detector scenarios, default realistic:\n");
+    ListScenarios();
+    printf("       -campaign, -job  derive disjoint random streams for job <index>\n");
+    printf("                        of campaign <seed>, default is a random seed\n");
+    printf("       -queue  generate event chunks leased from the queue <dir>, see\n");
+    printf("               batch/makeQueue.sh, until the queue is empty or <nEvents>\n");
+    printf("               are reached; <nEvents>=0 for no limit\n");
+    printf("       -target stop as soon as the integral of <histogram> over the pT range\n");
+    printf("               has a relative uncertainty below <relErr> for every target,\n");
+    printf("               checked every -check events (default 10000) or after each\n");
+    printf("               queue chunk; <nEvents> is then the maximum, 0 for no limit\n");
+    printf("       -input  analyse the events of a HepMC3 ASCII file, or generate from\n");
+    printf("               the hard processes of a Les Houches file; <nEvents>=0 for\n");
+    printf("               the whole file. Use a different -job for every file.\n");
+    printf("       -decayOnly  LHEF input: only decays, no showers or hadronisation\n");
+    printf("       -pileup, -mu  overlay Poisson(<mean>) minimum-bias events of the pool\n");
+    printf("               made by mkPileupPool.exe onto every event, 0 < <mean> <= 200\n");
+    printf("       -subprocesses  also keep the species and mass histograms of every Pythia\n");
+    printf("               subprocess, for Reweight.C; not with -input or -target\n");
+    printf("       -energies  comma-separated collision energies in GeV, default 13000.\n");
+    printf("               Each energy has its own generator and histograms (suffix\n");
+    printf("               _<eCM>GeV) and events alternate between them; <nEvents> is\n");
+    printf("               the sum over all energies. Not with -input or -subprocesses\n");
+    printf("       -deadMap  dead calorimeter cells, lines \"PHOS|EMCAL <module> <column> <row>\"\n");
+    printf("       -sigmaZ  Gaussian spread of the vertex along the beam, default 0;\n");
+    printf("               HepMC input keeps the vertex positions of the file\n");
+    printf("       -live, -liveEvery  publish the histograms to the snapshot <file> every\n");
+    printf("               <s> seconds (default 60) while running, see liveView.exe\n");
+    printf("       -hists  histograms to book, fill and write, see HistSpec.h; the\n");
+    printf("               spec of a run is saved in its output as histSpec\n");
     return 1;
   }
-  int nEvents = atoi(argv[1]);
+  int nEvents = atoi(argv[iArg]);
+
+  // one copy of every scenario per energy
+  if (energies.size() > 1) {
+    std::vector<Scenario> perEnergy;
+    for (size_t ie = 0; ie < energies.size(); ++ie) {
+      for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+	Scenario sc = scenarios[isc];
+	char tag[64];
+	sprintf(tag, "_%gGeV", energies[ie]);
+	sc.suffix += tag;
+	sc.energy  = ie;
+	perEnergy.push_back(sc);
+      }
+    }
+    scenarios.swap(perEnergy);
+  }
   cout << "nEvents = " << nEvents << endl;
 
+  // Random streams of this job. In queue mode every chunk has its own
+  // streams and all jobs initialise Pythia alike with those of chunk 0.
+  EventQueue queue;
+  if (queueDir) {
+    if (!OpenEventQueue(queueDir, queue)) return 1;
+    campaign = queue.campaign;
+    job      = 0;
+  }
+  int pythiaSeed;
+  ULong64_t smearSeed;
+  if (campaign >= 0) {
+    if (!PartitionSeeds(campaign, job, pythiaSeed, smearSeed)) return 1;
+  } else {
+    RandomSeeds(pythiaSeed, smearSeed);
+  }
+  RandomKey eventKey = {smearSeed, 0, 0};
+  printf("Pythia seed = %d, smearing seed = %016llx\n", pythiaSeed, smearSeed);
+
+  std::string deadCells;
+  if (deadMapFile && !ReadDeadChannelMap(deadMapFile, deadCells)) return 1;
+
+  PileupPool pileupPool;
+  if (pileupFile && !OpenPileupPool(pileupFile, pileupPool)) return 1;
+
   // Create the ROOT application environment. 
   TApplication theApp("hist", &argc, argv);
 
+  // one generator per energy, the first one is also used alone
   Pythia pythia;
-
-  Init(&(pythia));
+  std::vector<Pythia*> generators(1, &pythia);
+
+  std::string settings;
+  HepMCInput *hepmc = NULL;
+  if (hepmcInput) {
+    hepmc = OpenHepMCInput(inputFile);
+    if (!hepmc) return 1;
+    pythia.event.init("(HepMC input)", &pythia.particleData);
+    settings += "input = hepmc3\n";
+  } else {
+    for (size_t ie = 1; ie < energies.size(); ++ie) generators.push_back(new Pythia);
+    // beam spot: the calorimeter acceptance depends on the vertex
+    if (sigmaZ > 0.) {
+      char spreadLine[80];
+      sprintf(spreadLine, "Beams:sigmaVertexZ = %g", 10.*sigmaZ);  // mm
+      for (size_t ie = 0; ie < generators.size(); ++ie) {
+	generators[ie]->readString("Beams:allowVertexSpread = on");
+	generators[ie]->readString(spreadLine);
+      }
+      settings += std::string("Beams:allowVertexSpread = on\n") + spreadLine + "\n";
+    }
+    Init(&(pythia), pythiaSeed, energies[0], lhefInput ? inputFile : NULL, decayOnly, settings);
+    // the others have streams of their own; their settings differ by
+    // Beams:eCM only
+    for (size_t ie = 1; ie < energies.size(); ++ie) {
+      std::string settingsE;
+      Init(generators[ie], EnergySeed(pythiaSeed, ie), energies[ie], NULL, false, settingsE);
+    }
+  }
 
   cout << "List all decays of particle 10441, 20443, 445\n";
   pythia.particleData.list(10441);
   pythia.particleData.list(20443);
   pythia.particleData.list(445);
 
-  double ptMin = 0.;
-  double ptMax = 50.;  //GeV
-  double yMin  = 0.; 
-  double yMax  = 0.5; 
-  double phiMin = 0.;
-  double phiMax = 360.;
-  
-
-  const int nPtBins = 250;
-  const int nyBins  = 250; 
-  const double br[3] = {7.5819e-04, 202.383e-04, 114.624e-04};
-
   // rapidity range
   double ymax = 0.5;
   
-  // create histograms
-  TH1F *hChiC_phi_cndtn_3     = new TH1F("hChiC_phi_cndtn_3"     ,"All #chi_{cJ} #varphi spectrum" , 360, phiMin, phiMax);
-  hChiC_phi_cndtn_3->Sumw2();
-
-  TH1F *hChiC2_pt_all     = new TH1F("hChiC2_pt_all"     ,"All #chi_{c2} p_{T} spectrum" , nPtBins, ptMin, ptMax);
-  hChiC2_pt_all->Sumw2();
-
-  TH1F *hChiC2_pt_cndtn_1 = new TH1F("hChiC2_pt_cndtn_1" ,"#chi_{c2} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC2_pt_cndtn_1->Sumw2();
-
-  TH1F *hChiC2_y_cndtn_1  = new TH1F("hChiC2_y_cndtn_1"  ,"#chi_{c2} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC2_y_cndtn_1->Sumw2(); 
-
-  TH1F *hChiC2_pt_cndtn_2 = new TH1F("hChiC2_pt_cndtn_2" ,"#chi_{c2} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC2_pt_cndtn_2->Sumw2();
-
-  TH1F *hChiC2_y_cndtn_2  = new TH1F("hChiC2_y_cndtn_2"  ,"#chi_{c2} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC2_y_cndtn_2->Sumw2();
-
-  TH1F *hChiC2_pt_cndtn_3 = new TH1F("hChiC2_pt_cndtn_3" ,"#chi_{c2} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC2_pt_cndtn_3->Sumw2();
-
-  TH1F *hChiC2_y_cndtn_3  = new TH1F("hChiC2_y_cndtn_3"  ,"#chi_{c2} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC2_y_cndtn_3->Sumw2();
-
-  TH1F *hGamma_pt_all     = new TH1F("hGamma_pt_all"     ,"#gamma p_{T} spectrum ", nPtBins, ptMin, ptMax);
-  hGamma_pt_all->Sumw2();       
-  
-  TH1F *hPositron_pt_all  = new TH1F("hPositron_pt_all"  ,"e_{+}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hPositron_pt_all ->Sumw2();
-
-  TH1F *hElectron_pt_all  = new TH1F("hElectron_pt_all"  ,"e_{-}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hElectron_pt_all ->Sumw2();
-
-  TH1F *hChiC0_pt_all     = new TH1F("hChiC0_pt_all"     ,"All #chi_{c0} p_{T} spectrum" , nPtBins, ptMin, ptMax);
-  hChiC0_pt_all->Sumw2();
-
-  TH1F *hChiC0_pt_cndtn_1 = new TH1F("hChiC0_pt_cndtn_1" ,"#chi_{c0} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC0_pt_cndtn_1->Sumw2();
-
-  TH1F *hChiC0_y_cndtn_1  = new TH1F("hChiC0_y_cndtn_1"  ,"#chi_{c0} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC0_y_cndtn_1->Sumw2(); 
-
-  TH1F *hChiC0_pt_cndtn_2 = new TH1F("hChiC0_pt_cndtn_2" ,"#chi_{c0} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC0_pt_cndtn_2->Sumw2();
-
-  TH1F *hChiC0_y_cndtn_2  = new TH1F("hChiC0_y_cndtn_2"  ,"#chi_{c0} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC0_y_cndtn_2->Sumw2();
-
-  TH1F *hChiC0_pt_cndtn_3 = new TH1F("hChiC0_pt_cndtn_3" ,"#chi_{c0} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC0_pt_cndtn_3->Sumw2();
-
-  TH1F *hChiC0_y_cndtn_3  = new TH1F("hChiC0_y_cndtn_3"  ,"#chi_{c0} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC0_y_cndtn_3->Sumw2();
-
-  TH1F *hGamma_chic0_pt_all     = new TH1F("hGamma_chic0_pt_all"     ,"#gamma p_{T} spectrum ", nPtBins, ptMin, ptMax);
-  hGamma_chic0_pt_all->Sumw2();       
-  
-  TH1F *hPositron_chic0_pt_all  = new TH1F("hPositron_chic0_pt_all"  ,"e^{+}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hPositron_chic0_pt_all ->Sumw2();
-
-  TH1F *hElectron_chic0_pt_all  = new TH1F("hElectron_chic0_pt_all"  ,"e^{-}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hElectron_chic0_pt_all ->Sumw2();
-
-  TH1F *hChiC1_pt_all     = new TH1F("hChiC1_pt_all"     ,"All #chi_{c1} p_{T} spectrum" , nPtBins, ptMin, ptMax);
-  hChiC1_pt_all->Sumw2();
-
-  TH1F *hChiC1_pt_cndtn_1 = new TH1F("hChiC1_pt_cndtn_1" ,"#chi_{c1} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC1_pt_cndtn_1->Sumw2();
-
-  TH1F *hChiC1_y_cndtn_1  = new TH1F("hChiC1_y_cndtn_1"  ,"#chi_{c1} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC1_y_cndtn_1->Sumw2(); 
-
-  TH1F *hChiC1_pt_cndtn_2 = new TH1F("hChiC1_pt_cndtn_2" ,"#chi_{c1} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC1_pt_cndtn_2->Sumw2();
-
-  TH1F *hChiC1_y_cndtn_2  = new TH1F("hChiC1_y_cndtn_2"  ,"#chi_{c1} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC1_y_cndtn_2->Sumw2();
-
-  TH1F *hChiC1_pt_cndtn_3 = new TH1F("hChiC1_pt_cndtn_3" ,"#chi_{c1} p_{T} spectrum"  ,nPtBins, ptMin, ptMax);
-  hChiC1_pt_cndtn_3->Sumw2();
-
-  TH1F *hChiC1_y_cndtn_3  = new TH1F("hChiC1_y_cndtn_3"  ,"#chi_{c1} y spectrum"  ,nyBins, yMin, yMax);
-  hChiC1_y_cndtn_3->Sumw2();
-
-  TH1F *hGamma_chic1_pt_all     = new TH1F("hGamma_chic1_pt_all"     ,"#gamma p_{T} spectrum ", nPtBins, ptMin, ptMax);
-  hGamma_chic1_pt_all->Sumw2();       
-  
-  TH1F *hPositron_chic1_pt_all  = new TH1F("hPositron_chic1_pt_all"  ,"e^{+}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hPositron_chic1_pt_all ->Sumw2();
-
-  TH1F *hElectron_chic1_pt_all  = new TH1F("hElectron_chic1_pt_all"  ,"e^{-}  p_{T} spectrum", nPtBins, ptMin, ptMax);
-  hElectron_chic1_pt_all ->Sumw2();
-
-  TH2F *hMass2Gamma = new TH2F("hMass2Gamma","M(#gamma#gamma) vs p_{T}",150.,0.0,0.3,50,0.,50.);
-  hMass2Gamma->Sumw2();
-
-  TH2F *hMassElecPosi = new TH2F("hMassElecPosi","M(e^{+}e^{-}) vs p_{T}",200.,2.6,3.6,50,0.,50.);
-  hMassElecPosi->Sumw2();
-
-  TH2F *hMassGamElecPosi = new TH2F("hMassGamElecPosi","M(#gamma e^{+}e^{-}) vs p_{T}",200.,3.,4.,50,0.,50.);
-  hMassGamElecPosi->Sumw2();
-
-  TH2F *hMassGamElecPosi_cndtn_1 = new TH2F("hMassGamElecPosi_cndtn_1","M(#gamma e^{+}e^{-}) vs p_{T}",200.,3.,4.,50,0.,50.);
-  hMassGamElecPosi_cndtn_1->Sumw2();
-
-  TH2F *hMassGamElecPosi_cndtn_2 = new TH2F("hMassGamElecPosi_cndtn_2","M(#gamma e^{+}e^{-}) vs p_{T}",200.,3.,4.,50,0.,50.);
-  hMassGamElecPosi_cndtn_2->Sumw2();
-
-  TH2F *hMassGamElecPosi_cndtn_3 = new TH2F("hMassGamElecPosi_cndtn_3","M(#gamma e^{+}e^{-}) vs p_{T}",200.,3.,4.,50,0.,50.);
-  hMassGamElecPosi_cndtn_3->Sumw2();
-
-  TH2F *hMassGamElecPosi_mass_diff = new TH2F("hMassGamElecPosi_mass_diff","M(#gamma e^{+}e^{-}) vs p_{T}",160.,0.,0.8,50,0.,50.);
-  hMassGamElecPosi_mass_diff->Sumw2();
-
-  TH2F *hMassGamElecPosi_mass_diff_cndtn_1 = new TH2F("hMassGamElecPosi_mass_diff_cndtn_1","M(#gamma e^{+}e^{-}) vs p_{T}",160.,0.,0.8,50,0.,50.);
-  hMassGamElecPosi_mass_diff_cndtn_1->Sumw2();
-
-  TH2F *hMassGamElecPosi_mass_diff_cndtn_2 = new TH2F("hMassGamElecPosi_mass_diff_cndtn_2","M(#gamma e^{+}e^{-}) vs p_{T}",160.,0.,0.8,50,0.,50.);
-  hMassGamElecPosi_mass_diff_cndtn_2->Sumw2();
-
-  TH2F *hMassGamElecPosi_mass_diff_cndtn_3 = new TH2F("hMassGamElecPosi_mass_diff_cndtn_3","M(#gamma e^{+}e^{-}) vs p_{T}",160.,0.,0.8,50,0.,50.);
-  hMassGamElecPosi_mass_diff_cndtn_3->Sumw2();
+  // Quarkonium states and their decay patterns
+  SpeciesTable species;
+  InitSpecies(species);
+
+  // analysis settings that enter the settings hash
+  char line[1024];
+  for (size_t is = 0; is < species.species.size(); ++is) {
+    sprintf(line, "species %s = %s\n", species.species[is].name.c_str(),
+	    species.species[is].pattern.text.c_str());
+    settings += line;
+  }
+  sprintf(line, "scenarios = %s\nscan = %s\nsubprocesses = %s\n", scenarioList,
+	  scanMode ? "on" : "off", splitProcesses ? "on" : "off");
+  settings += line;
+  if (energies.size() > 1) settings += std::string("energies = ") + energyList + "\n";
+  if (deadMapFile) {
+    sprintf(line, "deadCells = %016llx\n", SettingsHash(deadCells));
+    settings += line;
+  }
+  if (pileupFile) {
+    sprintf(line, "pileupMu = %g\npileupECM = %g\npileupEtaMax = %g\n",
+	    pileupMu, pileupPool.header->eCM, pileupPool.header->etaMax);
+    settings += line;
+  }
 
-  TH2F **electrons_hist_array = new TH2F*[4];
+  // histograms as the spec says
+  HistSpec histSpec;
+  if (!ReadHistSpec(histSpecFile, histSpec)) return 1;
+  if (histSpecFile) {
+    sprintf(line, "histSpec = %016llx\n", SettingsHash(histSpec.text));
+    settings += line;
+  }
 
-  TH2F *hChiC_electrons_phi_rapid = new TH2F("hChiC_electrons_phi_rapid","all #chi_{cJ} #phi, y", 360., 0., TMath::TwoPi(), 100., -0.7, 0.7);
-  hChiC_electrons_phi_rapid->Sumw2();
+  // one set of species histograms per detector scenario
+  for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+    Scenario &sc = scenarios[isc];
+    BookHistSet(histSpec, species, sc.hists, sc.suffix.c_str());
+    if (scanMode) BookCutScan(species, sc.scan, sc.suffix.c_str());
+    sc.fill = &sc.hists;
+  }
 
-  electrons_hist_array[0] =  new TH2F("hChiC_electrons_phi_rapid_p0_0dot5","all #chi_{cJ} #phi, y", 360., 0., TMath::TwoPi(), 100., -0.7, 0.7);
-  electrons_hist_array[1] =  new TH2F("hChiC_electrons_phi_rapid_p0_1dot0","all #chi_{cJ} #phi, y", 360., 0., TMath::TwoPi(), 100., -0.7, 0.7);
-  electrons_hist_array[2] =  new TH2F("hChiC_electrons_phi_rapid_p0_1dot5","all #chi_{cJ} #phi, y", 360., 0., TMath::TwoPi(), 100., -0.7, 0.7);
-  electrons_hist_array[3] =  new TH2F("hChiC_electrons_phi_rapid_p0_2dot0","all #chi_{cJ} #phi, y", 360., 0., TMath::TwoPi(), 100., -0.7, 0.7);
- 
-  electrons_hist_array[0]->Sumw2();
-  electrons_hist_array[1]->Sumw2();
-  electrons_hist_array[2]->Sumw2();
-  electrons_hist_array[3]->Sumw2();
+  GlobalHists globals;
+  BookGlobalHists(histSpec, globals);
 
-  const int idChic0        =  10441;
-  const int idChic1        =  20443;
-  const int idChic2        =  445;
-  const int idJpsi         =  443;
-  const int idElectron     =  11;
   const int idPhoton       =  22;
   const int idPi0          =  111;
 
   int nEvent2Print = 1;
 
+  if (!FindPrecisionTargets(targets)) return 1;
+
+  // live snapshots of all histograms booked so far
+  LiveSnapshot live;
+  if (liveFile) {
+    std::vector<TH1*> liveHists;
+    TIter next(gROOT->GetList());
+    TObject *obj;
+    while ((obj = next())) {
+      TH1 *h = dynamic_cast<TH1*>(obj);
+      if (h && h->GetDimension() <= 2) liveHists.push_back(h);
+    }
+    if (!OpenLiveSnapshot(liveFile, liveHists, SettingsHash(settings), liveEvery, live)) return 1;
+  }
+  bool adaptive = !targets.empty();
+  const char *stopReason = queueDir ? "queue" : "nEvents";
+  // external mothers carry no Pythia status codes: take the last copy
+  bool anyStatus = inputFile != NULL;
+
   // Begin event loop. Generate event
 
   int iEvent2Print = 0;
-  for (int iEvent = 0; iEvent < nEvents; ++iEvent) {
-    if (!pythia.next()) continue;
-
-    // print first nEvent2Print events
-    if (iEvent2Print < nEvent2Print) pythia.event.list();
-    iEvent2Print++;
-    
-
-    // Loop over all particles in the generated event
-    double px,py,pz,p0;
-    
-    for (int i = 0; i < pythia.event.size(); ++i) {
-      // Select final-state chi_c2 within |y|<0.5
-      if (pythia.event[i].id() == idChic2 &&
-	  pythia.event[i].status() == -62 &&
-	  fabs(pythia.event[i].y()) <= ymax) {
-
-	Double_t pt = pythia.event[i].pT(); // transverse momentum 
-	hChiC2_pt_all->Fill(pt);
-	double ins_phi = pythia.event[i].phi();
-	if (ins_phi < 0) ins_phi += TMath::TwoPi();
-	Double_t y  = pythia.event[i].y();
- 
-
-	// Find daughters of chi_c2
-	int dghtChi1 = pythia.event[i].daughter1(); // first daughter
-	int dghtChi2 = pythia.event[i].daughter2(); // last  daughter
-
-	// skip event if the number of chi_c2 daughters is not 2
-	if (dghtChi2 - dghtChi1 != 1) continue;
-
-	// select decay chi_c2 -> J/psi gamma
-	if ( pythia.event[dghtChi1].id() == idJpsi    &&
-	     pythia.event[dghtChi2].id() == idPhoton)  {
-
-	  px = pythia.event[dghtChi2].px();
-	  py = pythia.event[dghtChi2].py();
-	  pz = pythia.event[dghtChi2].pz();
-	  p0 = pythia.event[dghtChi2].e();
-
-
-	  TLorentzVector pGam(px,py,pz,p0);
-	  TLorentzVector pGam_smeared = resolutionPhoton(pGam);
-
-	  int dghtJ1 = pythia.event[dghtChi1].daughter1();
-	  int dghtJ2 = pythia.event[dghtChi1].daughter2();
-
-	  // skip event if the number of J/psi daughters is not 2
-	  if (dghtJ2 - dghtJ1 != 1) continue;
-
-	  hGamma_pt_all->Fill(pGam_smeared.Pt(), br[2]);
-
-
-	  // select decay J/psi -> e+ e-
-
-	  if (abs(pythia.event[dghtJ1].id()) == idElectron &&
-	      abs(pythia.event[dghtJ2].id()) == idElectron) {
-              
-	    if (pythia.event[dghtJ1].id() == idElectron){
-
-	      px = pythia.event[dghtJ1].px();
-	      py = pythia.event[dghtJ1].py();
-	      pz = pythia.event[dghtJ1].pz();
-	      p0 = pythia.event[dghtJ1].e();
-	      
-	      double electron_y = pythia.event[dghtJ1].y();
-	      double electron_phi = pythia.event[dghtJ1].phi();
-	      if (electron_phi < 0){
-		electron_phi += TMath::TwoPi();
-	      }
-	      
-	      if (p0 >= 0.5){
-		electrons_hist_array[0]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 1.0){
-		electrons_hist_array[1]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 1.5){
-		electrons_hist_array[2]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 2.0){
-		electrons_hist_array[3]->Fill(electron_phi, electron_y);
-	      }
-	
-	      TLorentzVector pElec(px,py,pz,p0);
-	      TLorentzVector pElec_smeared = resolutionElectron(pElec);
-	      
-		
-	      px = pythia.event[dghtJ2].px();
-	      py = pythia.event[dghtJ2].py();
-	      pz = pythia.event[dghtJ2].pz();
-	      p0 = pythia.event[dghtJ2].e();
-
-	      
-	      cout << "phi_{e^{+}} = " << pythia.event[dghtJ2].phi() << " phi_{e^{-}} = " << pythia.event[dghtJ1].phi() << " phi_{gamma} = " << pythia.event[dghtChi2].phi() << "   |phi_{e^{+}} - phi_{e^{-}}|  = "  << fabs(pythia.event[dghtJ2].phi() - pythia.event[dghtJ1].phi()) << "     " << (pythia.event[dghtJ2].phi() + pythia.event[dghtJ1].phi())/2 - pythia.event[i].phi() <<  "\n";
-
-	      TLorentzVector pPosi(px,py,pz,p0);
-	      TLorentzVector pPosi_smeared = resolutionElectron(pPosi);
-
-	      hPositron_pt_all->Fill(pPosi_smeared.Pt(),br[2]);
-	      hElectron_pt_all->Fill(pElec_smeared.Pt(),br[2]);
-
-	      Invariant_mass_spectr_creator(pElec_smeared, pPosi_smeared, pGam_smeared,
-					    hMassElecPosi, hMassGamElecPosi, hMassGamElecPosi_cndtn_1,
-					    hMassGamElecPosi_cndtn_2, hMassGamElecPosi_cndtn_3, hMassGamElecPosi_mass_diff,
-					    hMassGamElecPosi_mass_diff_cndtn_1, hMassGamElecPosi_mass_diff_cndtn_2,
-					    hMassGamElecPosi_mass_diff_cndtn_3, br[2]);
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared))
-		{  
-		  
-		  hChiC2_pt_cndtn_1 ->Fill(pt,br[2]);
-		  hChiC2_y_cndtn_1  ->Fill(y,br[2]);
-
-		}
-
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared)   &&
-		  pGam_smeared.E() > 5.0)  
-		  
-		{ 
-		  
-		  hChiC2_pt_cndtn_2 ->Fill(pt,br[2]);
-		  hChiC2_y_cndtn_2  ->Fill(y,br[2]);
-	    
-		}
-
-
-	      if (IsPhotonDetectedInEMCAL(pElec_smeared) &&
-		  IsPhotonDetectedInEMCAL(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared))  
-		  
-		{ 
-		  
-		  hChiC2_pt_cndtn_3 ->Fill(pt,br[2]);
-		  hChiC2_y_cndtn_3  ->Fill(y,br[2]);
-	    
-		}
-	    }
+  std::vector<int> iNode;
+  PileupEvent pileup;
+  int nGenerated = 0;
+  double sumWeights = 0.;  // of the HepMC events
+  long nCandidates = 0;    // matched decay chains
+  std::string streams;
+  bool leaseLost = false;
+  for (;;) {
+    // Next work unit: the whole run, or the next chunk of the queue
+    int chunkEvents = ((adaptive || inputFile) && nEvents == 0) ? INT_MAX : nEvents;
+    if (queueDir) {
+      int chunk;
+      if (adaptive && nGenerated > 0 && PrecisionReached(targets)) {
+	stopReason = "precision";
+	break;
+      }
+      if (nEvents > 0 && nGenerated + queue.chunkEvents > nEvents) {
+	stopReason = "nEvents";
+	break;
+      }
+      if (!LeaseChunk(queue, chunk)) break;
+      if (!PartitionSeeds(campaign, chunk, pythiaSeed, smearSeed)) return 1;
+      for (size_t ie = 0; ie < generators.size(); ++ie) generators[ie]->rndm.init(EnergySeed(pythiaSeed, ie));
+      eventKey.seed = smearSeed;
+      chunkEvents   = queue.chunkEvents;
+      printf("Chunk %d: Pythia seed = %d, smearing seed = %016llx\n", chunk, pythiaSeed, smearSeed);
+      sprintf(line, "chunk = %d\n", chunk);
+      streams += line;
+    }
+    sprintf(line, "stream = %d/%016llx\n", pythiaSeed, smearSeed);
+    streams += line;
+
+    int iEvent;
+    for (iEvent = 0; iEvent < chunkEvents; ++iEvent) {
+      if (queueDir) {
+	// another job took over a chunk of this one: stop, nothing is written
+	if (!RenewLeases(queue)) {
+	  leaseLost = true;
+	  break;
+	}
+      }
+      // queue chunks always run to the end, so that their streams stay whole
+      else if (adaptive && iEvent > 0 && iEvent % checkEvery == 0 && PrecisionReached(targets)) {
+	stopReason = "precision";
+	break;
+      }
+      if (liveFile) UpdateLiveSnapshot(live, RunStatus(generators, nGenerated + iEvent));
+      // the generator of this event's energy
+      const int ie = iEvent % generators.size();
+      Pythia &gen = *generators[ie];
+      // weighted external events fill every histogram with their weight
+      double weight = 1.;
+      {
+	PROFILE_STAGE(kStageGenerate);
+	if (hepmc) {
+	  if (!ReadHepMCEvent(hepmc, gen.event, weight)) {
+	    stopReason = "input";
+	    break;
+	  }
+	  sumWeights += weight;
+	} else if (!gen.next()) {
+	  if (lhefInput && gen.info.atEndOfFile()) {
+	    stopReason = "input";
+	    break;
 	  }
+	  continue;
 	}
       }
-
-      if (pythia.event[i].id() == idChic0 &&
-	  pythia.event[i].status() ==-62 &&
-	  fabs(pythia.event[i].y()) <= ymax) {
-
-	Double_t pt = pythia.event[i].pT(); // transverse momentum
-	hChiC0_pt_all->Fill(pt);
-	double ins_phi = pythia.event[i].phi();
-	if (ins_phi < 0) ins_phi += TMath::TwoPi();
-	Double_t y  = pythia.event[i].y(); 
-
-	// Find daughters of chi_c0
-	int dghtChi1 = pythia.event[i].daughter1(); // first daughter
-	int dghtChi2 = pythia.event[i].daughter2(); // last  daughter
-
-	// skip event if the number of chi_c0 daughters is not 2
-	if (dghtChi2 - dghtChi1 != 1) continue;
-
-	// select decay chi_c0 -> J/psi gamma
-	if ( pythia.event[dghtChi1].id() == idJpsi    &&
-	     pythia.event[dghtChi2].id() == idPhoton)  {
-
-	  px = pythia.event[dghtChi2].px();
-	  py = pythia.event[dghtChi2].py();
-	  pz = pythia.event[dghtChi2].pz();
-	  p0 = pythia.event[dghtChi2].e();
-	  
-	  TLorentzVector pGam(px,py,pz,p0);
-	  
-	  TLorentzVector pGam_smeared = resolutionPhoton(pGam);
-
-	  int dghtJ1 = pythia.event[dghtChi1].daughter1();
-	  int dghtJ2 = pythia.event[dghtChi1].daughter2();
-
-	  
-	  // skip event if the number of J/psi daughters is not 2
-	  if (dghtJ2 - dghtJ1 != 1) continue;
-
-	  hGamma_chic0_pt_all->Fill(pGam_smeared.Pt(), br[0]);
-
-
-	  // select decay J/psi -> e+ e-
-	  if (abs(pythia.event[dghtJ1].id()) == idElectron &&
-	      abs(pythia.event[dghtJ2].id()) == idElectron) {
-              
-	    if (pythia.event[dghtJ1].id() == idElectron)  {
-	      px = pythia.event[dghtJ1].px();
-	      py = pythia.event[dghtJ1].py();
-	      pz = pythia.event[dghtJ1].pz();
-	      p0 = pythia.event[dghtJ1].e();
-
-	      double electron_y = pythia.event[dghtJ1].y();
-	      double electron_phi = pythia.event[dghtJ1].phi();
-	      if (electron_phi < 0){
-		electron_phi += TMath::TwoPi();
-	      }
-	     
-	      if (p0 >= 0.5){
-		electrons_hist_array[0]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 1.0){
-		electrons_hist_array[1]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 1.5){
-		electrons_hist_array[2]->Fill(electron_phi, electron_y);
-	      }
-
-	      if (p0 >= 2.0){
-		electrons_hist_array[3]->Fill(electron_phi, electron_y);
-	      }
-	
-	      TLorentzVector pElec(px,py,pz,p0);
-
-	      TLorentzVector pElec_smeared = resolutionElectron(pElec);
-		
-	      px = pythia.event[dghtJ2].px();
-	      py = pythia.event[dghtJ2].py();
-	      pz = pythia.event[dghtJ2].pz();
-	      p0 = pythia.event[dghtJ2].e();
-	      
-	      cout << "phi_{e^{+}} = " << pythia.event[dghtJ2].phi() << " phi_{e^{-}} = " << pythia.event[dghtJ1].phi() << " phi_{gamma} = " << pythia.event[dghtChi2].phi() << "\n";
-
-	      TLorentzVector pPosi(px,py,pz,p0);
-
-	      TLorentzVector pPosi_smeared = resolutionElectron(pPosi);
-
-
-	      Invariant_mass_spectr_creator(pElec_smeared, pPosi_smeared, pGam_smeared,
-					    hMassElecPosi, hMassGamElecPosi, hMassGamElecPosi_cndtn_1,
-					    hMassGamElecPosi_cndtn_2, hMassGamElecPosi_cndtn_3, hMassGamElecPosi_mass_diff,
-					    hMassGamElecPosi_mass_diff_cndtn_1, hMassGamElecPosi_mass_diff_cndtn_2,
-					    hMassGamElecPosi_mass_diff_cndtn_3, br[0]);
-
-	      hPositron_chic0_pt_all->Fill(pPosi_smeared.Pt(), br[0]);
-	      hElectron_chic0_pt_all->Fill(pElec_smeared.Pt(), br[0]);
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared)) 
-		 
-		{  
-		  
-		  hChiC0_pt_cndtn_1 ->Fill(pt, br[0]);
-		  hChiC0_y_cndtn_1  ->Fill(y, br[0]);
-
-		}
-
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared)   &&
-		  pGam_smeared.E() > 5.0)  
-		  
-		{ 
-		  
-		  hChiC0_pt_cndtn_2 ->Fill(pt, br[0]);
-		  hChiC0_y_cndtn_2  ->Fill(y, br[0]);
-	    
-		}
-
-	      if (IsPhotonDetectedInEMCAL(pElec_smeared) &&
-		  IsPhotonDetectedInEMCAL(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared))  
-		  
-		{ 
-
-		  hChiC0_pt_cndtn_3 ->Fill(pt,br[0]);
-		  hChiC0_y_cndtn_3  ->Fill(y,br[0]);
-	    
-		}
-	    }
+      eventKey.event = iEvent;
+      // the pileup is only needed for events with a candidate
+      bool havePileup = false;
+
+      // histograms of this subprocess, booked when it first occurs
+      if (splitProcesses) {
+	int code = gen.info.code();
+	for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+	  Scenario &sc = scenarios[isc];
+	  if (sc.energy != ie) continue;
+	  std::map<int,HistSet>::iterator ip = sc.process.find(code);
+	  if (ip == sc.process.end()) {
+	    ip = sc.process.insert(std::make_pair(code, HistSet())).first;
+	    sprintf(line, "%s_proc%d", sc.suffix.c_str(), code);
+	    BookHistSet(histSpec, species, ip->second, line);
 	  }
+	  sc.fill = &ip->second;
 	}
       }
 
-      if (pythia.event[i].id() == idChic1 &&
-	  pythia.event[i].status() ==-62 &&
-	  fabs(pythia.event[i].y()) <= ymax) {
-
-	Double_t pt = pythia.event[i].pT(); // transverse momentum
-	hChiC1_pt_all->Fill(pt);
-	double ins_phi = pythia.event[i].phi();
-	if (ins_phi < 0) ins_phi += TMath::TwoPi();
-	Double_t y  = pythia.event[i].y();
-
-
-	// Find daughters of chi_c1
-	int dghtChi1 = pythia.event[i].daughter1(); // first daughter
-	int dghtChi2 = pythia.event[i].daughter2(); // last  daughter
-
-	// skip event if the number of chi_c1 daughters is not 2
-	if (dghtChi2 - dghtChi1 != 1) continue;
-
-	// select decay chi_c1 -> J/psi gamma
-	if ( pythia.event[dghtChi1].id() == idJpsi    &&
-	     pythia.event[dghtChi2].id() == idPhoton)  {
-
-	  px = pythia.event[dghtChi2].px();
-	  py = pythia.event[dghtChi2].py();
-	  pz = pythia.event[dghtChi2].pz();
-	  p0 = pythia.event[dghtChi2].e();
-	  
-	  TLorentzVector pGam(px,py,pz,p0);
-	  
-	  TLorentzVector pGam_smeared = resolutionPhoton(pGam);
-
-	  int dghtJ1 = pythia.event[dghtChi1].daughter1();
-	  int dghtJ2 = pythia.event[dghtChi1].daughter2();
-
-	  
-	  // skip event if the number of J/psi daughters is not 2
-	  if (dghtJ2 - dghtJ1 != 1) continue;
-
-	  hGamma_chic1_pt_all->Fill(pGam_smeared.Pt(), br[1]);
-
-
-	  // select decay J/psi -> e+ e-
-	  if (abs(pythia.event[dghtJ1].id()) == idElectron &&
-	      abs(pythia.event[dghtJ2].id()) == idElectron) {
-              
-	    if (pythia.event[dghtJ1].id() == idElectron)  {
-
-	      px = pythia.event[dghtJ1].px();
-	      py = pythia.event[dghtJ1].py();
-	      pz = pythia.event[dghtJ1].pz();
-	      p0 = pythia.event[dghtJ1].e();
-
-	      double electron_y = pythia.event[dghtJ1].y();
-	      double electron_phi = pythia.event[dghtJ1].phi();
-	      if (electron_phi < 0){
-		electron_phi += TMath::TwoPi();
-	      }
-
-	      if (p0 >= 0.5){
-		electrons_hist_array[0]->Fill(electron_phi, electron_y);
-	      }
+      // print first nEvent2Print events
+      if (iEvent2Print < nEvent2Print) {
+	PROFILE_STAGE(kStagePrint);
+	gen.event.list();
+      }
+      iEvent2Print++;
+    
 
-	      if (p0 >= 1.0){
-		electrons_hist_array[1]->Fill(electron_phi, electron_y);
-	      }
+      // Loop over all particles in the generated event
+      PROFILE_STAGE(kStageParticles);
+      double px,py,pz,p0;
+    
+      for (int i = 0; i < gen.event.size(); ++i) {
+	// Select quarkonium states within |y|<0.5 and match their decay chains
+	std::map<int,int>::const_iterator is = species.dispatch.find(gen.event[i].id());
+	if (is != species.dispatch.end()) {
+	  const Species &sp = species.species[is->second];
+	  bool mother = anyStatus ? gen.event[i].iBotCopyId() == i
+				  : gen.event[i].status() == sp.status;
+	  if (mother && fabs(gen.event[i].y()) <= ymax) {
+
+	    {
+	      PROFILE_STAGE(kStageFill);
+	      double var[kNVars];
+	      var[kVarPt]  = gen.event[i].pT();
+	      var[kVarY]   = gen.event[i].y();
+	      var[kVarPhi] = PhiPositive(gen.event[i].phi());
+	      for (size_t isc = 0; isc < scenarios.size(); ++isc)
+		if (scenarios[isc].energy == ie)
+		  FillHistList(scenarios[isc].fill->species[is->second].mother, kCondAll, var, sp.br, weight);
+	    }
 
-	      if (p0 >= 1.5){
-		electrons_hist_array[2]->Fill(electron_phi, electron_y);
+	    if (MatchDecayPattern(gen.event, i, sp.pattern, iNode)) {
+	      nCandidates++;
+	      // the histograms outside the scenarios are those of the first energy
+	      if (ie == 0)
+		FillTrueCandidate(gen.event, species, is->second, iNode, weight, globals.electron);
+	      if (pileupFile && !havePileup) {
+		PROFILE_STAGE(kStagePileup);
+		OverlayPileup(pileupPool, pileupMu, eventKey, pileup);
+		havePileup = true;
 	      }
-
-	      if (p0 >= 2.0){
-		electrons_hist_array[3]->Fill(electron_phi, electron_y);
+	      for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+		Scenario &sc = scenarios[isc];
+		if (sc.energy != ie) continue;
+		sc.analyse(gen.event, species, is->second, iNode, eventKey, weight,
+			   pileupFile ? &pileup : NULL, *sc.fill, scanMode ? &sc.scan : NULL);
 	      }
-	      
-	
-	      TLorentzVector pElec(px,py,pz,p0);
-
-	      TLorentzVector pElec_smeared = resolutionElectron(pElec);
-		
-	      px = pythia.event[dghtJ2].px();
-	      py = pythia.event[dghtJ2].py();
-	      pz = pythia.event[dghtJ2].pz();
-	      p0 = pythia.event[dghtJ2].e();
-
-	      cout << "phi_{e^{+}} = " << pythia.event[dghtJ2].phi() << " phi_{e^{-}} = " << pythia.event[dghtJ1].phi() << " phi_{gamma} = " << pythia.event[dghtChi2].phi() << "\n";
-
-	      TLorentzVector pPosi(px,py,pz,p0);
-
-	      TLorentzVector pPosi_smeared = resolutionElectron(pPosi);
-
-	      Invariant_mass_spectr_creator(pElec_smeared, pPosi_smeared, pGam_smeared,
-					    hMassElecPosi, hMassGamElecPosi, hMassGamElecPosi_cndtn_1,
-					    hMassGamElecPosi_cndtn_2, hMassGamElecPosi_cndtn_3, hMassGamElecPosi_mass_diff,
-					    hMassGamElecPosi_mass_diff_cndtn_1, hMassGamElecPosi_mass_diff_cndtn_2,
-					    hMassGamElecPosi_mass_diff_cndtn_3, br[1]);
-
-	      hPositron_chic1_pt_all->Fill(pPosi_smeared.Pt(), br[1]);
-	      hElectron_chic1_pt_all->Fill(pElec_smeared.Pt(), br[1]);
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared)) 
-		 
-		{  
-		  
-		  hChiC1_pt_cndtn_1 ->Fill(pt, br[1]);
-		  hChiC1_y_cndtn_1  ->Fill(y, br[1]);
-
-		}
-
-
-	      if (IsElectronDetectedInCTS(pElec_smeared) &&
-		  IsElectronDetectedInCTS(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared)   &&
-		  pGam_smeared.E() > 5.0)  
-		  
-		{ 
-		  
-		  hChiC1_pt_cndtn_2 ->Fill(pt, br[1]);
-		  hChiC1_y_cndtn_2  ->Fill(y, br[1]);
-	    
-		}
-
-	      if (IsPhotonDetectedInEMCAL(pElec_smeared) &&
-		  IsPhotonDetectedInEMCAL(pPosi_smeared) &&
-		  IsPhotonDetectedInPHOS(pGam_smeared))  
-		  
-		{ 
-
-		  hChiC1_pt_cndtn_3 ->Fill(pt,br[1]);
-		  hChiC1_y_cndtn_3  ->Fill(y,br[1]);
-	    
-		}
 	    }
 	  }
+	  continue;
 	}
-      }
 
-      // Select pi0 within |y|<0.5
-      if (pythia.event[i].id() == idPi0 &&
-	  fabs(pythia.event[i].y()) <= ymax) {
-
-	// Find daughters of pi0
-	int dghtPi01 = pythia.event[i].daughter1(); // first daughter
-	int dghtPi02 = pythia.event[i].daughter2(); // last  daughter
-
-	// skip event if the number of daughters is not 2
-	if (dghtPi02 - dghtPi01 != 1) continue;
-	// select decay pi0 -> gamma gamma
-	if ( pythia.event[dghtPi01].id() == idPhoton   &&
-	     pythia.event[dghtPi02].id() == idPhoton)  {
-
-	  px = pythia.event[dghtPi01].px();
-	  py = pythia.event[dghtPi01].py();
-	  pz = pythia.event[dghtPi01].pz();
-	  p0 = pythia.event[dghtPi01].e();
-	  TLorentzVector pGam1(px,py,pz,p0);
-	  TLorentzVector pGam1_smeared = resolutionPhoton(pGam1);
-
-	  px = pythia.event[dghtPi02].px();
-	  py = pythia.event[dghtPi02].py();
-	  pz = pythia.event[dghtPi02].pz();
-	  p0 = pythia.event[dghtPi02].e();
- 	  TLorentzVector pGam2(px,py,pz,p0);
-	  TLorentzVector pGam2_smeared = resolutionPhoton(pGam2);
-
-	  hMass2Gamma->Fill((pGam1_smeared + pGam2_smeared).M(),
-			    (pGam1_smeared + pGam2_smeared).Pt());
+	// Select pi0 within |y|<0.5
+	if (ie == 0 && !globals.pi0.hist.empty() && gen.event[i].id() == idPi0 &&
+	    fabs(gen.event[i].y()) <= ymax) {
+
+	  // Find daughters of pi0
+	  int dghtPi01 = gen.event[i].daughter1(); // first daughter
+	  int dghtPi02 = gen.event[i].daughter2(); // last  daughter
+
+	  // skip event if the number of daughters is not 2
+	  if (dghtPi02 - dghtPi01 != 1) continue;
+	  // select decay pi0 -> gamma gamma
+	  if ( gen.event[dghtPi01].id() == idPhoton   &&
+	       gen.event[dghtPi02].id() == idPhoton)  {
+
+	    px = gen.event[dghtPi01].px();
+	    py = gen.event[dghtPi01].py();
+	    pz = gen.event[dghtPi01].pz();
+	    p0 = gen.event[dghtPi01].e();
+	    TLorentzVector pGam1(px,py,pz,p0);
+	    RandomKey key = eventKey;
+	    key.particle = dghtPi01;
+	    TLorentzVector pGam1_smeared = resolutionPhoton(pGam1, key);
+
+	    px = gen.event[dghtPi02].px();
+	    py = gen.event[dghtPi02].py();
+	    pz = gen.event[dghtPi02].pz();
+	    p0 = gen.event[dghtPi02].e();
+	    TLorentzVector pGam2(px,py,pz,p0);
+	    key.particle = dghtPi02;
+	    TLorentzVector pGam2_smeared = resolutionPhoton(pGam2, key);
+
+	    PROFILE_STAGE(kStageFill);
+	    double var[kNVars];
+	    var[kVarM]  = (pGam1_smeared + pGam2_smeared).M();
+	    var[kVarPt] = (pGam1_smeared + pGam2_smeared).Pt();
+	    FillHistList(globals.pi0, kCondAll, var, 1., weight);
+	  }
 	}
-      }
-    } // End of particle loop
-  } // End of event loop
+      } // End of particle loop
+    } // End of event loop
+
+    nGenerated += iEvent;
+    if (!queueDir || leaseLost) break;
+  } // End of chunk loop
+
+  // the fills of a chunk taken over cannot be told apart from the others:
+  // drop the whole output and give the other chunks back to the queue
+  if (queueDir && (leaseLost || !RenewLeases(queue, true))) {
+    printf("Error: a lease of this job was taken over, its output is not written\n");
+    ReleaseLeases(queue);
+    return 1;
+  }
+
+  // decay-only LHEF input decays the quarkonia of the file: none matched
+  // means the settings or the file are wrong, not an empty spectrum
+  if (decayOnly && nGenerated > 0 && nCandidates == 0) {
+    printf("Error: -decayOnly: no matched decay chain in %d events of %s\n", nGenerated, inputFile);
+    return 1;
+  }
+
+  // the last snapshot, before the spectra are scaled
+  if (liveFile) CloseLiveSnapshot(live, RunStatus(generators, nGenerated));
 
   // Statistics on event generation.
-  pythia.stat();
+  if (!hepmc)
+    for (size_t ie = 0; ie < generators.size(); ++ie) generators[ie]->stat();
+
+  // Precision achieved, before the spectra are scaled
+  if (adaptive) {
+    PrecisionReached(targets);
+    printf("Stopped by %s after %d events\n", stopReason, nGenerated);
+    for (size_t it = 0; it < targets.size(); ++it)
+      printf("  %-40s %6.2f < pT < %6.2f  target %8.4f  achieved %8.4f\n",
+	     targets[it].name.c_str(), targets[it].ptMin, targets[it].ptMax,
+	     targets[it].goal, targets[it].achieved);
+  }
 
-  // Convert histograms to differential cross sections
+  // Convert histograms to differential cross sections; with several
+  // energies the histograms outside the scenarios are those of the first
   double xsection = pythia.info.sigmaGen();
+  double sigmaErr = pythia.info.sigmaErr();
   int ntrials  = pythia.info.nAccepted();
-  double sigmaweight = xsection/ntrials;
+  if (hepmc) {
+    HepMCCrossSection(hepmc, xsection, sigmaErr);
+    ntrials = nGenerated;
+    CloseHepMCInput(hepmc);
+    if (xsection <= 0.) {
+      printf("Warning: no GenCrossSection in %s, spectra are per event\n", inputFile);
+      xsection = 1.;
+    }
+    // no events, or weights cancelling: no normalisation, nothing to write
+    if (sumWeights <= 0.) {
+      printf("Error: the events of %s have a sum of weights %g, not normalised and not written\n",
+	     inputFile, sumWeights);
+      return 1;
+    }
+  }
+  // weighted HepMC events: the cross section per unit of summed weight
+  double sigmaweight = hepmcInput ? xsection/sumWeights : xsection/ntrials;
   
 
-  // normalize pT spectra
-  double ptBinSize = (ptMax-ptMin) / nPtBins;
-  double yBinSize  = (yMax-yMin) / nyBins;
-
-  hChiC_phi_cndtn_3       ->Scale(sigmaweight/(1. * 2. * 360.)); 
-  hChiC2_pt_all            ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC0_pt_all            ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC1_pt_all            ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hGamma_pt_all            ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hGamma_chic0_pt_all      ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hGamma_chic1_pt_all      ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hElectron_pt_all         ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hElectron_chic0_pt_all   ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hElectron_chic1_pt_all   ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hPositron_pt_all         ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hPositron_chic0_pt_all   ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hPositron_chic1_pt_all   ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC2_pt_cndtn_1        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC0_pt_cndtn_1        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC1_pt_cndtn_1        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC2_pt_cndtn_2        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC0_pt_cndtn_2        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC1_pt_cndtn_2        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC2_pt_cndtn_3        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC0_pt_cndtn_3        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC1_pt_cndtn_3        ->Scale(sigmaweight/(ptBinSize * 2. * ymax));
-  hChiC2_y_cndtn_1         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC0_y_cndtn_1         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC1_y_cndtn_1         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC2_y_cndtn_2         ->Scale(sigmaweight/(yBinSize * 2. * ymax)); 
-  hChiC0_y_cndtn_2         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC1_y_cndtn_2         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC2_y_cndtn_3         ->Scale(sigmaweight/(yBinSize * 2. * ymax)); 
-  hChiC0_y_cndtn_3         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
-  hChiC1_y_cndtn_3         ->Scale(sigmaweight/(yBinSize * 2. * ymax));
+  // normalize the spectra of norm xsec
+  ScaleHistList(globals.electron, sigmaweight, 2. * ymax);
+  ScaleHistList(globals.pi0,      sigmaweight, 2. * ymax);
+  for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+    Scenario &sc = scenarios[isc];
+    // several energies: the cross section of the scenario's generator
+    double scWeight = sigmaweight;
+    if (generators.size() > 1)
+      scWeight = generators[sc.energy]->info.sigmaGen()/generators[sc.energy]->info.nAccepted();
+    if (splitProcesses) {
+      // every subprocess with its own cross section, the sum is the total
+      for (std::map<int,HistSet>::iterator ip = sc.process.begin(); ip != sc.process.end(); ++ip) {
+	double weight = pythia.info.sigmaGen(ip->first)/pythia.info.nAccepted(ip->first);
+	ScaleHistSet(ip->second, weight, 2. * ymax);
+	AddHistSet(sc.hists, ip->second);
+      }
+    } else {
+      ScaleHistSet(sc.hists, scWeight, 2. * ymax);
+    }
+
+    // integrate the scan over the thresholds, yields in cross-section units
+    if (scanMode) {
+      CumulateCutScan(sc.scan);
+      ScaleCutScan(sc.scan, scWeight);
+    }
+  }
 
   // Save histogram on file and close file.
-  char fn[1024];
-  sprintf(fn, "%s", "pythia_chic2.root");
-  TFile* outFile = new TFile(fn, "RECREATE");
-
-  hChiC_phi_cndtn_3                 ->Write();
-  hChiC2_pt_all                     ->Write();
-  hChiC0_pt_all                     ->Write();
-  hChiC1_pt_all                     ->Write();
-  hChiC2_pt_cndtn_1                 ->Write();
-  hChiC0_pt_cndtn_1                 ->Write();
-  hChiC1_pt_cndtn_1                 ->Write();
-  hChiC2_y_cndtn_1                  ->Write();
-  hChiC0_y_cndtn_1                  ->Write();
-  hChiC1_y_cndtn_1                  ->Write();
-  hChiC2_pt_cndtn_2                 ->Write();
-  hChiC0_pt_cndtn_2                 ->Write();
-  hChiC1_pt_cndtn_2                 ->Write();
-  hChiC2_y_cndtn_2                  ->Write();
-  hChiC0_y_cndtn_2                  ->Write();
-  hChiC1_y_cndtn_2                  ->Write();
-  hChiC2_pt_cndtn_3                 ->Write();
-  hChiC0_pt_cndtn_3                 ->Write();
-  hChiC1_pt_cndtn_3                 ->Write();
-  hChiC2_y_cndtn_3                  ->Write();
-  hChiC0_y_cndtn_3                  ->Write();
-  hChiC1_y_cndtn_3                  ->Write();
-  hGamma_pt_all                     ->Write();
-  hGamma_chic0_pt_all               ->Write();
-  hGamma_chic1_pt_all               ->Write();
-  hElectron_pt_all                  ->Write();
-  hElectron_chic0_pt_all            ->Write();
-  hElectron_chic1_pt_all            ->Write();
-  hPositron_pt_all                  ->Write();
-  hPositron_chic0_pt_all            ->Write();
-  hPositron_chic1_pt_all            ->Write();
-  hMass2Gamma                       ->Write();
-  hMassElecPosi                     ->Write();
-  hMassGamElecPosi                  ->Write();
-  hMassGamElecPosi_cndtn_1          ->Write();
-  hMassGamElecPosi_cndtn_2          ->Write();
-  hMassGamElecPosi_cndtn_3          ->Write();
-  hMassGamElecPosi_mass_diff        ->Write();
-  hMassGamElecPosi_mass_diff_cndtn_1->Write();
-  hMassGamElecPosi_mass_diff_cndtn_2->Write();
-  hMassGamElecPosi_mass_diff_cndtn_3->Write();
-  hChiC_electrons_phi_rapid         ->Write();
-  electrons_hist_array[0]           ->Write();
-  electrons_hist_array[1]           ->Write();
-  electrons_hist_array[2]           ->Write();
-  electrons_hist_array[3]           ->Write();
-
-  outFile->Close();
-  delete outFile;
+  {
+    PROFILE_STAGE(kStageWrite);
+    char fn[1024];
+    sprintf(fn, "%s", "pythia_chic2.root");
+    TFile* outFile = new TFile(fn, "RECREATE");
+
+    std::string histNorms;
+    for (size_t isc = 0; isc < scenarios.size(); ++isc) {
+      WriteHistSet(scenarios[isc].hists, histNorms);
+      std::map<int,HistSet> &process = scenarios[isc].process;
+      for (std::map<int,HistSet>::iterator ip = process.begin(); ip != process.end(); ++ip)
+	WriteHistSet(ip->second, histNorms);
+      if (scanMode) WriteCutScan(scenarios[isc].scan);
+    }
+    WriteGlobalHists(globals, histNorms);
+    TObjString specText(histSpec.text.c_str());
+    specText.Write("histSpec");
+    TObjString normText(histNorms.c_str());
+    normText.Write("histNorm");
+
+    // Run manifest: streams, event range and settings of this output.
+    // Every stream (job or queue chunk) starts at event 0.
+    std::string manifest;
+    if (queueDir)
+      sprintf(line, "campaign = %d\nqueue = %s\nchunkEvents = %d\n",
+	      campaign, queueDir, queue.chunkEvents);
+    else
+      sprintf(line, "campaign = %d\njob = %d\npythiaSeed = %d\nsmearSeed = %016llx\nfirstEvent = %d\n",
+	      campaign, job, pythiaSeed, smearSeed, 0);
+    manifest += line;
+    manifest += streams;
+    if (inputFile) manifest += std::string("input = ") + inputFile + "\n";
+    if (hepmcInput) {
+      sprintf(line, "sumWeights = %g\n", sumWeights);
+      manifest += line;
+    }
+    if (pileupFile) manifest += std::string("pileupPool = ") + pileupFile + "\n";
+    if (deadMapFile) manifest += std::string("deadMap = ") + deadMapFile + "\n";
+    manifest += "histSpec = " + histSpec.source + "\n";
+    // with several energies there is no run cross section, only those of
+    // the energies below, and nAccepted is their sum
+    if (generators.size() > 1) {
+      long nAcceptedAll = 0;
+      for (size_t ie = 0; ie < generators.size(); ++ie) nAcceptedAll += generators[ie]->info.nAccepted();
+      sprintf(line, "nEvents = %d\nnAccepted = %ld\nsettingsHash = %016llx\n",
+	      nGenerated, nAcceptedAll, SettingsHash(settings));
+    } else {
+      sprintf(line, "nEvents = %d\nnAccepted = %d\nsigmaGen = %g\nsigmaErr = %g\nsettingsHash = %016llx\n",
+	      nGenerated, ntrials, xsection, sigmaErr, SettingsHash(settings));
+    }
+    manifest += line;
+    sprintf(line, "stop = %s\n", stopReason);
+    manifest += line;
+    // energy = <eCM> <nAccepted> <sigmaGen> <sigmaErr> <Pythia seed>, one
+    // per generator
+    if (!hepmcInput) {
+      for (size_t ie = 0; ie < generators.size(); ++ie) {
+	sprintf(line, "energy = %g %ld %g %g %d\n", energies[ie], generators[ie]->info.nAccepted(),
+		generators[ie]->info.sigmaGen(), generators[ie]->info.sigmaErr(),
+		EnergySeed(pythiaSeed, ie));
+	manifest += line;
+      }
+    }
+    // process = <code> <nAccepted> <sigmaGen> <sigmaErr> <name>, see Reweight.C
+    if (splitProcesses) {
+      std::map<int,HistSet> &process = scenarios[0].process;
+      for (std::map<int,HistSet>::iterator ip = process.begin(); ip != process.end(); ++ip) {
+	int code = ip->first;
+	sprintf(line, "process = %d %ld %g %g %s\n", code, pythia.info.nAccepted(code),
+		pythia.info.sigmaGen(code), pythia.info.sigmaErr(code), pythia.info.nameProc(code).c_str());
+	manifest += line;
+      }
+    }
+    // target = <histogram> <ptMin> <ptMax> <target> <achieved>, achieved < 0 if empty
+    for (size_t it = 0; it < targets.size(); ++it) {
+      sprintf(line, "target = %s %g %g %g %g\n", targets[it].name.c_str(), targets[it].ptMin,
+	      targets[it].ptMax, targets[it].goal, targets[it].achieved);
+      manifest += line;
+    }
+    for (size_t pos = 0; pos < settings.size(); ) {
+      size_t end = settings.find('\n', pos);
+      manifest += "setting = " + settings.substr(pos, end - pos) + "\n";
+      pos = end + 1;
+    }
+    WriteManifest(fn, outFile, manifest);
+
+    outFile->Close();
+    delete outFile;
+  }
+
+  if (pileupFile) ClosePileupPool(pileupPool);
+
+  // the chunks are safely on disk now
+  if (queueDir && !CompleteLeases(queue)) return 1;
+
+  PrintStageProfile();
 
   cout << "\nProgram exited without errors!\n\n";
 
@@ -1,24 +1,11 @@
-#include "TLorentzVector.h"
-Double_t smearP(Double_t);
-#include <math.h>
+#include "DetectorPolicy.h"
 
 // This function generates smeared electron 4-momentum from the true one
+// with the reference detector, bremsstrahlung in the material included;
+// other scenarios use RadiateElectron<> and SmearTrack<> directly
 
-TLorentzVector resolutionElectron(TLorentzVector pTrue)
+TLorentzVector resolutionElectron(TLorentzVector pTrue, const RandomKey &key)
 {
-  // Get particle mass
-  Double_t Mass = pTrue.M();
-  // Get true absolute 3-momentum from true 4-momentum
-  Double_t p3True = pTrue.P();
-  // Generated smeared absolute 3-momentum
-  Double_t p3Smeared = smearP(p3True);
-  // Calculate smeared components of 3-vector
-  Double_t pxSmeared = pTrue.Px() * p3Smeared/p3True;
-  Double_t pySmeared = pTrue.Py() * p3Smeared/p3True;
-  Double_t pzSmeared = pTrue.Pz() * p3Smeared/p3True;
-  // Calculate new energy from smeared 3-momentum and mass
-  Double_t Esmeared = sqrt(p3Smeared*p3Smeared + Mass*Mass);
-  // Construct new 4-momentum from smeared energy and 3-momentum
-  TLorentzVector pSmeared(pxSmeared,pySmeared,pzSmeared,Esmeared);
-  return pSmeared;
+  TLorentzVector pRadiated = RadiateElectron<RealisticDetector::Material>(pTrue, key);
+  return SmearTrack<RealisticDetector::Momentum>(pRadiated, key);
 }
@@ -1,14 +1,9 @@
-#include "TLorentzVector.h"
-#include "TRandom.h"
-#include <math.h>
+#include "DetectorPolicy.h"
 
-Double_t smearE(Double_t Etrue)
+Double_t smearE(Double_t Etrue, const RandomKey &key)
 {
   // Generate smeared photon energy from the true energy
-  const Double_t a = 0.018, b = 0.033, c = 0.011; // Energy resolution of ALICE PHOS
-  // const Double_t a = 0.00, b = 0.000, c = 0.00; // for studies ideal resolution
-  Double_t sigmaE = Etrue * sqrt(a*a/Etrue/Etrue + b*b/Etrue + c*c);
-  Double_t Esmeared = gRandom->Gaus(Etrue,sigmaE);
-  if (Esmeared<0) Esmeared = 0;
-  return Esmeared;
+  // with the energy resolution of ALICE PHOS, see PhosEnergyRes.
+  // The draw depends only on key, see CounterRandom.h
+  return SmearEnergy<RealisticDetector::Energy>(Etrue, key);
 }